@@ -0,0 +1,34 @@
+/*
+ * GATT Alert Level - Níveis de alerta dos serviços de proximidade
+ */
+
+/**
+ * @file alert_level.h
+ * @brief Valores da característica Alert Level (0x2A06)
+ * 
+ * Compartilhado pelos serviços do Proximity Profile do Bluetooth SIG que
+ * usam a característica Alert Level (Link Loss Service e Immediate Alert
+ * Service).
+ */
+
+#ifndef GATT_ALERT_LEVEL_H_
+#define GATT_ALERT_LEVEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Níveis de alerta (característica Alert Level, 1 byte)
+ */
+typedef enum {
+	GATT_ALERT_LEVEL_NONE = 0x00,     /**< Sem alerta */
+	GATT_ALERT_LEVEL_MILD = 0x01,     /**< Alerta moderado */
+	GATT_ALERT_LEVEL_HIGH = 0x02,     /**< Alerta máximo */
+} gatt_alert_level_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GATT_ALERT_LEVEL_H_ */
@@ -11,9 +11,16 @@
  * móveis leiam o nível da bateria.
  * 
  * Características:
- * - Battery Level: Leitura e notificação do percentual de bateria (0-100%)
+ * - Battery Level: Leitura e notificação do percentual de bateria (0-100%),
+ *   notificado apenas em mudanças significativas (histerese + rate limit)
  * - Battery Voltage: Leitura da tensão em mV (customizado)
  * - Battery State: Leitura do estado (Critical, Low, Medium, Good) (customizado)
+ * - Battery Status: Nível, tensão, estado, idade e sequência da amostra em um
+ *   único PDU, com leitura e notificação (customizado)
+ * - Battery History: Download do histórico de tensão em rajadas de
+ *   notificações; escrever 0x01 inicia e 0x00 interrompe (customizado)
+ * - Battery Forecast: Dias restantes até bateria crítica, com a tendência
+ *   de tensão usada na estimativa (customizado)
  * 
  * Compatível com Android, iOS e outros dispositivos BLE que suportam
  * o Battery Service padrão.
@@ -66,8 +73,11 @@ int gatt_battery_service_init(const struct gatt_battery_service_cb *callbacks);
  * Envia notificação BLE aos clientes conectados que habilitaram
  * notificações da característica Battery Level.
  * 
- * Esta função deve ser chamada quando o nível da bateria mudar
- * significativamente (ex: a cada 5% de mudança).
+ * O serviço já notifica automaticamente a partir das amostragens
+ * periódicas do HAL Battery quando o nível muda mais que
+ * CONFIG_GATT_BATTERY_NOTIFY_DELTA_PCT ou o estado muda. Esta função
+ * força uma notificação imediata, fora desse controle, enviada a todas
+ * as conexões inscritas.
  * 
  * @param percentage Novo percentual de bateria (0-100%)
  * 
@@ -0,0 +1,75 @@
+/*
+ * GATT Immediate Alert Service - Alarme disparado pelo central
+ */
+
+/**
+ * @file immediate_alert_service.h
+ * @brief Interface do Immediate Alert Service (0x1802)
+ *
+ * Implementa o Immediate Alert Service padrão do Bluetooth (Proximity
+ * Profile). O central grava na característica Alert Level o nível de
+ * alerta a ser tocado imediatamente pela coleira.
+ *
+ * Características:
+ * - Alert Level (0x2A06): Escrita sem resposta (None, Mild, High), como
+ *   exige a especificação. O alarme não espera a ida e volta de um ATT
+ *   Write Response.
+ *
+ * Comportamento:
+ * - Escrita de um nível: alerta imediato naquele nível (None desliga)
+ * - Desconexão: o nível volta a None; o buzzer fica a cargo do Link
+ *   Loss Service (alarme na perda de enlace, silêncio se solicitada)
+ */
+
+#ifndef GATT_IMMEDIATE_ALERT_SERVICE_H_
+#define GATT_IMMEDIATE_ALERT_SERVICE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gatt/alert_level.h"
+
+/**
+ * @brief Estrutura de callbacks do Immediate Alert Service
+ */
+struct gatt_immediate_alert_service_cb {
+	/**
+	 * @brief Callback chamado quando o central grava um nível de alerta
+	 *
+	 * Também é chamado com GATT_ALERT_LEVEL_NONE quando o central que
+	 * gravou o nível se desconecta e outros celulares seguem conectados.
+	 * Na desconexão do último, o que fazer com o buzzer é decidido pelo
+	 * Link Loss Service. Executado na thread RX do Bluetooth: não deve
+	 * bloquear.
+	 *
+	 * @param level Nível de alerta a aplicar
+	 */
+	void (*alert_cb)(gatt_alert_level_t level);
+};
+
+/**
+ * @brief Inicializa o Immediate Alert Service
+ *
+ * @param callbacks Estrutura de callbacks (pode ser NULL se não usar)
+ *
+ * @return 0 em caso de sucesso
+ * @return Código de erro negativo em caso de falha
+ */
+int gatt_immediate_alert_service_init(const struct gatt_immediate_alert_service_cb *callbacks);
+
+/**
+ * @brief Retorna o nível do alerta imediato em andamento
+ *
+ * @return Último nível gravado pelo central (NONE se não há alerta)
+ */
+gatt_alert_level_t gatt_immediate_alert_service_get_level(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GATT_IMMEDIATE_ALERT_SERVICE_H_ */
@@ -0,0 +1,84 @@
+/*
+ * GATT Link Loss Service - Alerta local na perda do enlace BLE
+ */
+
+/**
+ * @file link_loss_service.h
+ * @brief Interface do Link Loss Service (0x1803)
+ * 
+ * Implementa o Link Loss Service padrão do Bluetooth (Proximity Profile).
+ * O central grava na característica Alert Level o nível de alerta a ser
+ * disparado pela coleira quando o enlace cair por timeout de supervisão,
+ * sem depender do celular para perceber a perda.
+ * 
+ * Características:
+ * - Alert Level (0x2A06): Leitura e escrita do nível (None, Mild, High),
+ *   mantido entre conexões
+ * 
+ * Comportamento:
+ * - Desconexão por perda de enlace: alerta no nível configurado, até a
+ *   reconexão ou até CONFIG_GATT_LINK_LOSS_ALERT_TIMEOUT_S
+ * - Desconexão solicitada (pelo central ou localmente): sem alerta
+ * - Com vários celulares conectados, apenas a queda da última conexão é
+ *   considerada
+ */
+
+#ifndef GATT_LINK_LOSS_SERVICE_H_
+#define GATT_LINK_LOSS_SERVICE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gatt/alert_level.h"
+
+/**
+ * @brief Estrutura de callbacks do Link Loss Service
+ */
+struct gatt_link_loss_service_cb {
+	/**
+	 * @brief Callback chamado quando o alerta de perda de enlace muda
+	 * 
+	 * Chamado com o nível configurado na perda de enlace e com
+	 * GATT_ALERT_LEVEL_NONE na reconexão, no fim do tempo de alerta ou em
+	 * uma desconexão solicitada (que não deve deixar o alarme tocando).
+	 * Executado na thread RX do Bluetooth ou na work queue do sistema:
+	 * não deve bloquear.
+	 * 
+	 * @param level Nível de alerta a aplicar
+	 */
+	void (*alert_cb)(gatt_alert_level_t level);
+};
+
+/**
+ * @brief Inicializa o Link Loss Service
+ * 
+ * @param callbacks Estrutura de callbacks (pode ser NULL se não usar)
+ * 
+ * @return 0 em caso de sucesso
+ * @return Código de erro negativo em caso de falha
+ */
+int gatt_link_loss_service_init(const struct gatt_link_loss_service_cb *callbacks);
+
+/**
+ * @brief Retorna o nível de alerta configurado para a perda de enlace
+ * 
+ * @return Nível de alerta atual
+ */
+gatt_alert_level_t gatt_link_loss_service_get_level(void);
+
+/**
+ * @brief Verifica se o alerta de perda de enlace está ativo
+ * 
+ * @return true entre a perda de enlace e a reconexão (ou o fim do alerta)
+ */
+bool gatt_link_loss_service_is_alerting(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GATT_LINK_LOSS_SERVICE_H_ */
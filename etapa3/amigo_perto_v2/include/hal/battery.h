@@ -15,7 +15,18 @@
  * - Leitura da tensão da bateria via ADC
  * - Cálculo do percentual de carga
  * - Gerenciamento de estados de carga (Critical, Low, Medium, Good)
- * - Otimizado para bateria tipo moeda (CR2032: 3.0V nominal, 2.0V mínimo)
+ * - Snapshot em cache atualizado periodicamente em segundo plano
+ * - Curva de descarga por química de bateria via devicetree
+ *   (padrão: bateria tipo moeda CR2032: 3.0V nominal, 2.0V mínimo)
+ * - Medição sob carga (buzzer): percentual e estado são calculados
+ *   pela tensão sob carga, que cai antes da tensão em repouso
+ * - Compensação de temperatura (temperatura do die) e calibração do ADC
+ *   apenas quando a temperatura varia
+ * - Aviso de bateria crítica por interrupção do comparador POF (nRF52)
+ * - Aquisição periódica disparada por hardware (RTC + PPI + EasyDMA),
+ *   com aviso de tensão crítica pelo limite inferior do SAADC
+ * - Leitura assíncrona com callback de conclusão; consumidores que pedem
+ *   leitura durante uma conversão compartilham o mesmo resultado
  */
 
 #ifndef HAL_BATTERY_H_
@@ -27,6 +38,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <zephyr/sys/slist.h>
 
 /**
  * @brief Códigos de erro do HAL Battery
@@ -36,6 +48,8 @@ typedef enum {
 	HAL_BATTERY_ERROR_INIT = -1,      /**< Erro na inicialização */
 	HAL_BATTERY_ERROR_READ = -2,      /**< Erro na leitura do ADC */
 	HAL_BATTERY_ERROR_STATE = -3,     /**< Estado inválido (não inicializado) */
+	HAL_BATTERY_ERROR_NO_DATA = -4,   /**< Nenhuma amostra disponível em cache */
+	HAL_BATTERY_ERROR_STALE = -5,     /**< Amostra em cache mais antiga que o limite */
 } hal_battery_error_t;
 
 /**
@@ -60,11 +74,66 @@ typedef enum {
  * @brief Estrutura com informações da bateria
  */
 typedef struct {
-	uint16_t voltage_mv;              /**< Tensão em milivolts */
+	uint16_t voltage_mv;              /**< Tensão em repouso em milivolts */
+	uint16_t loaded_mv;               /**< Tensão estimada sob carga (0 se sem medição recente) */
+	uint16_t effective_mv;            /**< Tensão do percentual e do estado (sob carga, compensada) */
 	uint8_t percentage;               /**< Percentual de carga (0-100%) */
 	hal_battery_state_t state;        /**< Estado de carga */
 } hal_battery_info_t;
 
+/**
+ * @brief Snapshot da bateria em cache, com metadados da amostra
+ */
+typedef struct {
+	hal_battery_info_t info;          /**< Informações da bateria */
+	int64_t timestamp_ms;             /**< k_uptime_get() no momento da amostra */
+	uint32_t sequence;                /**< Número de sequência (incrementa a cada amostra) */
+} hal_battery_snapshot_t;
+
+/**
+ * @brief Callback chamado a cada amostragem periódica da bateria
+ * 
+ * Executado na work queue do sistema logo após o snapshot em cache ser
+ * atualizado. Não deve bloquear por longos períodos.
+ * 
+ * @param info Leitura recém-amostrada
+ */
+typedef void (*hal_battery_sample_cb_t)(const hal_battery_info_t *info);
+
+/**
+ * @brief Callback chamado quando a bateria entra em estado crítico
+ * 
+ * Disparado pelo comparador POF (CONFIG_HAL_BATTERY_POF_WARNING), uma
+ * única vez, e executado na work queue do sistema depois que o snapshot
+ * em cache já reflete HAL_BATTERY_STATE_CRITICAL.
+ */
+typedef void (*hal_battery_critical_cb_t)(void);
+
+/**
+ * @brief Callback de conclusão de uma leitura assíncrona
+ * 
+ * Executado na work queue do sistema quando a conversão termina. Não
+ * deve bloquear por longos períodos.
+ * 
+ * @param result HAL_BATTERY_SUCCESS ou HAL_BATTERY_ERROR_READ
+ * @param voltage_mv Tensão lida em mV (válida apenas em sucesso)
+ * @param user_data Ponteiro informado no pedido
+ */
+typedef void (*hal_battery_read_cb_t)(int result, uint16_t voltage_mv, void *user_data);
+
+/**
+ * @brief Pedido de leitura assíncrona da tensão
+ * 
+ * Alocado pelo chamador e mantido válido até a chamada do callback. O
+ * mesmo pedido pode ser reutilizado (inclusive dentro do callback).
+ */
+typedef struct {
+	sys_snode_t node;                 /**< Uso interno (fila de pedidos) */
+	hal_battery_read_cb_t cb;         /**< Callback de conclusão */
+	void *user_data;                  /**< Repassado ao callback */
+	bool exclusive;                   /**< Exige conversão própria, iniciada após o pedido */
+} hal_battery_read_req_t;
+
 /**
  * @brief Inicializa o subsistema de monitoramento de bateria
  * 
@@ -81,21 +150,49 @@ int hal_battery_init(void);
  * 
  * Realiza uma leitura do ADC e retorna a tensão em milivolts.
  * Esta função realiza múltiplas leituras e calcula a média para maior precisão.
+ * No modo de aquisição por hardware, retorna a média do último buffer.
+ * 
+ * Bloqueia até o fim da conversão (via hal_battery_read_voltage_async()).
+ * Como a conclusão roda na work queue do sistema, não pode ser chamada a
+ * partir dela.
  * 
  * @param voltage_mv Ponteiro para armazenar a tensão lida (em mV)
  * 
  * @return HAL_BATTERY_SUCCESS em caso de sucesso
- * @return HAL_BATTERY_ERROR_STATE se não inicializado
+ * @return HAL_BATTERY_ERROR_STATE se não inicializado ou chamada na work
+ *         queue do sistema
  * @return HAL_BATTERY_ERROR_READ se houver erro na leitura
  */
 int hal_battery_read_voltage(uint16_t *voltage_mv);
 
+/**
+ * @brief Solicita uma leitura da tensão sem bloquear o chamador
+ * 
+ * A conversão é disparada com adc_read_async() e req->cb é chamado na
+ * work queue do sistema ao seu fim. Pedidos feitos enquanto uma conversão
+ * está em andamento são atendidos por ela: vários consumidores (GATT,
+ * histórico, alarme) disparam uma única leitura do ADC. Um pedido com
+ * exclusive = true aguarda uma conversão própria (ex.: medição sob carga,
+ * que não pode aproveitar uma conversão iniciada antes da carga).
+ * 
+ * Um pedido que já aguarda uma conversão não é enfileirado novamente.
+ * Pode ser chamada de qualquer contexto, inclusive interrupção.
+ * 
+ * @param req Pedido com cb preenchido
+ * 
+ * @return HAL_BATTERY_SUCCESS se o pedido foi aceito
+ * @return HAL_BATTERY_ERROR_STATE se não inicializado
+ * @return HAL_BATTERY_ERROR_READ se req ou req->cb for NULL
+ */
+int hal_battery_read_voltage_async(hal_battery_read_req_t *req);
+
 /**
  * @brief Calcula o percentual de carga da bateria
  * 
  * Converte a tensão em mV para percentual de carga estimado (0-100%).
- * Utiliza interpolação linear baseada nas características de descarga
- * de bateria tipo moeda (CR2032).
+ * Utiliza interpolação linear inteira sobre a curva de descarga definida
+ * no devicetree (compatible "amigo,battery"), ou sobre a curva padrão
+ * de bateria tipo moeda (CR2032) se o nó não existir.
  * 
  * @param voltage_mv Tensão da bateria em milivolts
  * 
@@ -103,6 +200,18 @@ int hal_battery_read_voltage(uint16_t *voltage_mv);
  */
 uint8_t hal_battery_voltage_to_percentage(uint16_t voltage_mv);
 
+/**
+ * @brief Calcula a tensão correspondente a um percentual de carga
+ * 
+ * Inversa de hal_battery_voltage_to_percentage(), sobre a mesma curva de
+ * descarga. Útil para converter limiares de estado em tensão.
+ * 
+ * @param percentage Percentual de carga (0-100%)
+ * 
+ * @return Tensão da bateria em milivolts
+ */
+uint16_t hal_battery_percentage_to_voltage(uint8_t percentage);
+
 /**
  * @brief Determina o estado de carga da bateria
  * 
@@ -118,7 +227,15 @@ hal_battery_state_t hal_battery_percentage_to_state(uint8_t percentage);
  * @brief Obtém informações completas da bateria
  * 
  * Lê a tensão da bateria e calcula todas as informações derivadas
- * (percentual e estado) em uma única operação.
+ * (percentual e estado) em uma única operação. O resultado também
+ * atualiza o snapshot em cache.
+ * 
+ * Se houver medição sob carga recente (hal_battery_sample_loaded()), a
+ * queda sob carga medida é aplicada à leitura em repouso e o percentual
+ * e o estado são calculados pela tensão sob carga resultante.
+ * 
+ * Esta função bloqueia durante a conversão do ADC. Em contextos sensíveis
+ * a latência, use hal_battery_get_cached().
  * 
  * @param info Ponteiro para estrutura onde as informações serão armazenadas
  * 
@@ -128,12 +245,109 @@ hal_battery_state_t hal_battery_percentage_to_state(uint8_t percentage);
  */
 int hal_battery_get_info(hal_battery_info_t *info);
 
+/**
+ * @brief Obtém o último snapshot da bateria sem acessar o ADC
+ * 
+ * Retorna a última leitura armazenada em cache pela amostragem periódica
+ * em segundo plano. Não bloqueia e pode ser chamada de qualquer contexto
+ * de thread (ex.: callbacks GATT na thread RX do Bluetooth).
+ * 
+ * Se o snapshot for mais antigo que max_age_ms, os valores ainda são
+ * copiados para info, uma nova amostragem é agendada imediatamente e
+ * HAL_BATTERY_ERROR_STALE é retornado.
+ * 
+ * @param info Ponteiro para estrutura onde as informações serão armazenadas
+ * @param max_age_ms Idade máxima aceitável do snapshot em milissegundos
+ * 
+ * @return HAL_BATTERY_SUCCESS se o snapshot está dentro da idade máxima
+ * @return HAL_BATTERY_ERROR_STALE se o snapshot está desatualizado
+ * @return HAL_BATTERY_ERROR_NO_DATA se nenhuma leitura foi feita ainda
+ * @return HAL_BATTERY_ERROR_STATE se não inicializado
+ * @return HAL_BATTERY_ERROR_READ se info for NULL
+ */
+int hal_battery_get_cached(hal_battery_info_t *info, uint32_t max_age_ms);
+
+/**
+ * @brief Obtém o último snapshot com timestamp e número de sequência
+ * 
+ * Mesma semântica de hal_battery_get_cached(), mas inclui os metadados
+ * da amostra para consumidores que precisam informar a idade da leitura
+ * ou detectar amostras repetidas.
+ * 
+ * @param snapshot Ponteiro para estrutura onde o snapshot será armazenado
+ * @param max_age_ms Idade máxima aceitável do snapshot em milissegundos
+ * 
+ * @return Mesmos códigos de hal_battery_get_cached()
+ */
+int hal_battery_get_snapshot(hal_battery_snapshot_t *snapshot, uint32_t max_age_ms);
+
+/**
+ * @brief Agenda uma medição da tensão sob carga
+ * 
+ * Deve ser chamada quando uma carga relevante e sustentada estiver ativa
+ * (ex.: PWM do buzzer ligado). A leitura é feita na work queue do sistema
+ * após delay_ms, e a diferença em relação à última leitura em repouso é
+ * registrada como a queda sob carga da bateria. Rajadas curtas de rádio
+ * já terminaram quando a conversão ocorre: medidas assim sobrescreveriam
+ * a queda do buzzer por um valor próximo do repouso.
+ * 
+ * Pedidos feitos antes de CONFIG_HAL_BATTERY_LOAD_MIN_INTERVAL_MS desde a
+ * última medição sob carga, ou com uma medição já agendada, são ignorados.
+ * Pode ser chamada de qualquer contexto de thread.
+ * 
+ * No modo de aquisição por hardware (CONFIG_HAL_BATTERY_SAMPLING_PPI) não
+ * há conversão sob demanda; quedas sob carga são capturadas pelo limite
+ * inferior do SAADC.
+ * 
+ * @param delay_ms Tempo de acomodação da carga antes da leitura (ms)
+ * 
+ * @return HAL_BATTERY_SUCCESS em caso de sucesso (ou pedido ignorado)
+ * @return HAL_BATTERY_ERROR_STATE se não inicializado ou no modo PPI
+ */
+int hal_battery_sample_loaded(uint32_t delay_ms);
+
+/**
+ * @brief Sinaliza que a carga de hal_battery_sample_loaded() se desligou
+ * 
+ * Cancela a medição agendada e descarta a conversão em andamento, que
+ * terminaria sem carga (ex.: fase desligada do buzzer intermitente). Pode
+ * ser chamada de qualquer contexto de thread.
+ */
+void hal_battery_load_ended(void);
+
+/**
+ * @brief Registra um callback para as amostragens periódicas
+ * 
+ * Permite que consumidores (ex.: notificações GATT) reajam às novas
+ * amostras sem fazer polling nem disparar leituras próprias do ADC.
+ * 
+ * @param cb Função a ser chamada a cada amostragem periódica
+ * 
+ * @return HAL_BATTERY_SUCCESS em caso de sucesso
+ * @return HAL_BATTERY_ERROR_READ se cb for NULL
+ * @return HAL_BATTERY_ERROR_STATE se não houver espaço para novos callbacks
+ */
+int hal_battery_register_sample_cb(hal_battery_sample_cb_t cb);
+
+/**
+ * @brief Registra um callback para o evento de bateria crítica
+ * 
+ * @param cb Função a ser chamada quando o comparador POF disparar
+ * 
+ * @return HAL_BATTERY_SUCCESS em caso de sucesso
+ * @return HAL_BATTERY_ERROR_READ se cb for NULL
+ * @return HAL_BATTERY_ERROR_STATE se não houver espaço para novos callbacks
+ */
+int hal_battery_register_critical_cb(hal_battery_critical_cb_t cb);
+
 /**
  * @brief Verifica se a bateria está em nível crítico
  * 
- * Função auxiliar para verificação rápida de bateria crítica.
+ * Função auxiliar para verificação rápida de bateria crítica. Com
+ * CONFIG_HAL_BATTERY_POF_WARNING, consulta o comparador POF e o snapshot
+ * em cache, sem acessar o ADC; caso contrário, realiza uma leitura.
  * 
- * @return true se bateria está crítica (< 10%)
+ * @return true se bateria está crítica (< 10% ou POFWARN disparado)
  * @return false caso contrário ou se não inicializado
  */
 bool hal_battery_is_critical(void);
@@ -0,0 +1,74 @@
+/*
+ * HAL Battery Forecast - Estimativa de autonomia da bateria
+ */
+
+/**
+ * @file battery_forecast.h
+ * @brief Interface da estimativa de dias restantes até bateria crítica
+ * 
+ * Este módulo ajusta uma regressão linear por mínimos quadrados sobre uma
+ * janela deslizante das tensões amostradas e extrapola a reta até a tensão
+ * em que o HAL Battery passa a reportar HAL_BATTERY_STATE_CRITICAL.
+ * 
+ * Características:
+ * - Aritmética inteira (ponto fixo), sem float
+ * - Atualização O(1) por amostra (somatórios deslizantes)
+ * - Estimativa pronta para leitura em qualquer contexto (sem cálculo
+ *   no caminho de leitura)
+ */
+
+#ifndef HAL_BATTERY_FORECAST_H_
+#define HAL_BATTERY_FORECAST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Valor de days_remaining quando a tensão não está em queda
+ */
+#define HAL_BATTERY_FORECAST_UNKNOWN  0xFFFF
+
+/**
+ * @brief Estimativa de autonomia da bateria
+ */
+typedef struct {
+	uint16_t days_remaining;          /**< Dias até o estado crítico (ou HAL_BATTERY_FORECAST_UNKNOWN) */
+	int32_t slope_uv_per_day;         /**< Tendência da tensão (uV/dia, negativa em descarga) */
+	uint16_t fitted_mv;               /**< Tensão atual segundo a reta ajustada (mV) */
+	uint16_t critical_mv;             /**< Limiar crítico em tensão de repouso, com a queda atual (mV) */
+	uint16_t samples;                 /**< Amostras na janela de regressão */
+} hal_battery_forecast_t;
+
+/**
+ * @brief Inicializa a estimativa de autonomia
+ * 
+ * Registra o módulo nas amostragens periódicas do HAL Battery. Deve ser
+ * chamada após hal_battery_init().
+ * 
+ * @return HAL_BATTERY_SUCCESS em caso de sucesso
+ * @return Código de erro do HAL Battery em caso de falha
+ */
+int hal_battery_forecast_init(void);
+
+/**
+ * @brief Obtém a última estimativa de autonomia
+ * 
+ * Não bloqueia e pode ser chamada de qualquer contexto de thread.
+ * 
+ * @param forecast Ponteiro para estrutura onde a estimativa será armazenada
+ * 
+ * @return HAL_BATTERY_SUCCESS em caso de sucesso
+ * @return HAL_BATTERY_ERROR_NO_DATA se ainda não há amostras suficientes
+ *         (os campos samples e critical_mv são preenchidos mesmo assim)
+ * @return HAL_BATTERY_ERROR_READ se forecast for NULL
+ */
+int hal_battery_get_forecast(hal_battery_forecast_t *forecast);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_BATTERY_FORECAST_H_ */
@@ -0,0 +1,102 @@
+/*
+ * HAL Battery History - Histórico compactado de tensão da bateria
+ */
+
+/**
+ * @file battery_history.h
+ * @brief Interface do histórico de tensão da bateria
+ * 
+ * Este módulo mantém um ring buffer em RAM com as amostras de tensão da
+ * bateria em cadência fixa, codificadas em delta (1 byte por amostra),
+ * permitindo registrar semanas de curva de descarga em poucos KB.
+ * Opcionalmente, o histórico é persistido em flash (subsistema settings).
+ * 
+ * Codificação:
+ * - A amostra mais antiga do ring é guardada em valor absoluto (mV)
+ * - Cada amostra seguinte é um int8 com a diferença para a anterior, em
+ *   unidades de CONFIG_HAL_BATTERY_HISTORY_RESOLUTION_MV
+ * - Saltos maiores que o delta máximo são saturados e compensados nas
+ *   amostras seguintes (o erro não se acumula)
+ * 
+ * As amostras são numeradas por uma sequência monotônica, de modo que um
+ * consumidor (ex.: download via GATT) detecta se o trecho que está lendo
+ * foi sobrescrito durante a leitura.
+ */
+
+#ifndef HAL_BATTERY_HISTORY_H_
+#define HAL_BATTERY_HISTORY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Descrição do conteúdo atual do histórico
+ */
+typedef struct {
+	uint32_t first_seq;               /**< Sequência da amostra mais antiga */
+	uint16_t count;                   /**< Número de amostras armazenadas */
+	uint16_t first_mv;                /**< Tensão absoluta da amostra mais antiga (mV) */
+	uint16_t interval_s;              /**< Cadência nominal das amostras (s) */
+	uint8_t resolution_mv;            /**< Unidade dos deltas (mV) */
+} hal_battery_history_info_t;
+
+/**
+ * @brief Inicializa o histórico de bateria
+ * 
+ * Restaura o histórico persistido (se habilitado) e registra o módulo
+ * nas amostragens periódicas do HAL Battery. Deve ser chamada após
+ * hal_battery_init().
+ * 
+ * @return HAL_BATTERY_SUCCESS em caso de sucesso
+ * @return Código de erro do HAL Battery em caso de falha
+ */
+int hal_battery_history_init(void);
+
+/**
+ * @brief Registra uma amostra de tensão no histórico
+ * 
+ * Chamada automaticamente a partir das amostragens periódicas do HAL
+ * Battery, respeitando a cadência CONFIG_HAL_BATTERY_HISTORY_INTERVAL_S.
+ * 
+ * @param voltage_mv Tensão da bateria em milivolts
+ */
+void hal_battery_history_record(uint16_t voltage_mv);
+
+/**
+ * @brief Obtém a descrição do conteúdo atual do histórico
+ * 
+ * @param info Ponteiro para estrutura onde a descrição será armazenada
+ * 
+ * @return HAL_BATTERY_SUCCESS em caso de sucesso
+ * @return HAL_BATTERY_ERROR_READ se info for NULL
+ */
+int hal_battery_history_get_info(hal_battery_history_info_t *info);
+
+/**
+ * @brief Copia deltas do histórico a partir de uma sequência
+ * 
+ * Os deltas são copiados como armazenados: o da amostra mais antiga é
+ * relativo a uma amostra já descartada. Quem reconstrói a série a partir
+ * do first_mv de hal_battery_history_get_info() deve tratar como 0 o
+ * delta do first_seq daquela consulta (e só dele: o first_seq atual
+ * avança enquanto o ring descarta amostras).
+ * 
+ * @param seq Sequência da primeira amostra a copiar
+ * @param buf Buffer de destino
+ * @param max_len Número máximo de amostras a copiar
+ * 
+ * @return Número de amostras copiadas (0 se seq está além da mais recente)
+ * @return HAL_BATTERY_ERROR_NO_DATA se seq já foi sobrescrita
+ * @return HAL_BATTERY_ERROR_READ se buf for NULL
+ */
+int hal_battery_history_read(uint32_t seq, int8_t *buf, size_t max_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_BATTERY_HISTORY_H_ */
@@ -14,10 +14,32 @@
  * 
  * Funcionalidades:
  * - Inicialização do stack BLE
- * - Controle de advertising (anúncio)
- * - Gerenciamento de conexões
- * - Leitura de RSSI
+ * - Controle de advertising (anúncio), com cronograma de intervalos
+ *   crescentes (reconexão rápida seguida de economia de energia)
+ * - Gerenciamento de até CONFIG_BT_MAX_CONN conexões simultâneas, com
+ *   advertising mantido enquanto houver vaga
+ * - Perfis de parâmetros de conexão (IDLE/ALERT) negociados com o central
+ * - Amostragem periódica do RSSI da conexão principal, com fila de
+ *   amostras e callbacks de assinatura
+ * - Monitoramento de perda de percurso pelo controlador (LE Power
+ *   Control), com a amostragem de RSSI como alternativa
+ * - Gerenciador de PHY: 2M para transferências em massa, LE Coded na
+ *   borda do dome, com estatística do tempo em cada PHY
+ * - Advertising estendido no LE Coded para o build de longo alcance
+ * - Estado da coleira (bateria, alarme) nos dados de fabricante do
+ *   advertising, legível por quem apenas escaneia
+ * - Trem de advertising periódico com o mesmo estado, para vários
+ *   observadores sincronizados
+ * - Beacon não conectável concorrente ao advertising de conexão (radar
+ *   por RSSI), cada conjunto com intervalo e potência próprios
+ * - Controle adaptativo da potência de transmissão das conexões, com
+ *   piso durante o alarme
  * - Callbacks para eventos BLE
+ * 
+ * Conexão principal: a mais antiga das conexões ativas. É a que acompanha
+ * o dome virtual: segue o perfil de parâmetros da aplicação e tem o
+ * enlace monitorado (RSSI ou perda de percurso). As demais conexões ficam
+ * no perfil IDLE. Quando a principal cai, outra conexão ativa assume.
  */
 
 #ifndef HAL_BLE_H_
@@ -52,20 +74,100 @@ typedef enum {
 typedef enum {
 	HAL_BLE_STATE_IDLE = 0,           /**< Ocioso (não inicializado) */
 	HAL_BLE_STATE_READY,              /**< Pronto mas não anunciando */
-	HAL_BLE_STATE_ADVERTISING,        /**< Anunciando (advertising) */
-	HAL_BLE_STATE_CONNECTED,          /**< Conectado a um dispositivo */
+	HAL_BLE_STATE_ADVERTISING,        /**< Anunciando (advertising), com ou sem conexões */
+	HAL_BLE_STATE_CONNECTED,          /**< Conectado e sem advertising */
 } hal_ble_state_t;
 
+/**
+ * @brief Número máximo de estágios do cronograma de advertising
+ */
+#define HAL_BLE_ADV_MAX_STAGES 4
+
+/**
+ * @brief Estágio do cronograma de advertising
+ */
+typedef struct {
+	uint16_t interval_min_ms;         /**< Intervalo mínimo em ms (20-10240) */
+	uint16_t interval_max_ms;         /**< Intervalo máximo em ms (20-10240) */
+	uint32_t duration_s;              /**< Duração do estágio em s (0 = indefinida) */
+} hal_ble_adv_stage_t;
+
 /**
  * @brief Parâmetros de advertising
+ * 
+ * Com stages != NULL, o advertising percorre o cronograma a cada início
+ * (inclusive o reinício automático após uma desconexão), e
+ * interval_min_ms/interval_max_ms são ignorados. O último estágio dura
+ * indefinidamente.
  */
 typedef struct {
 	uint16_t interval_min_ms;         /**< Intervalo mínimo em ms (20-10240) */
 	uint16_t interval_max_ms;         /**< Intervalo máximo em ms (20-10240) */
 	bool connectable;                 /**< Permite conexões */
 	bool use_identity;                /**< Usa endereço de identidade */
+	const hal_ble_adv_stage_t *stages; /**< Cronograma de estágios (NULL = intervalo fixo) */
+	uint8_t stage_count;              /**< Número de estágios (até HAL_BLE_ADV_MAX_STAGES) */
 } hal_ble_adv_params_t;
 
+/**
+ * @brief Conjuntos de advertising com potência de transmissão própria
+ */
+typedef enum {
+	HAL_BLE_ADV_SET_CONN = 0,         /**< Advertising de conexão */
+	HAL_BLE_ADV_SET_BEACON,           /**< Beacon não conectável (CONFIG_HAL_BLE_BEACON) */
+	HAL_BLE_ADV_SET_COUNT,            /**< Número de conjuntos */
+} hal_ble_adv_set_t;
+
+/**
+ * @brief Parâmetros do beacon não conectável
+ */
+typedef struct {
+	uint16_t interval_ms;             /**< Intervalo em ms (20-10240) */
+	int8_t tx_power_dbm;              /**< Potência de transmissão (-40 a +8 dBm) */
+} hal_ble_beacon_params_t;
+
+/**
+ * @brief Perfis de parâmetros de conexão
+ * 
+ * O perfil é negociado com o central via bt_conn_le_param_update() depois
+ * que a descoberta de serviços se acomoda (CONFIG_HAL_BLE_CONN_SETTLE_MS).
+ */
+typedef enum {
+	HAL_BLE_CONN_PROFILE_IDLE = 0,    /**< Intervalo longo com latência: menor consumo */
+	HAL_BLE_CONN_PROFILE_ALERT,       /**< Intervalo e timeout curtos: alarme e perda de enlace rápidos */
+} hal_ble_conn_profile_t;
+
+/**
+ * @brief PHY da conexão
+ */
+typedef enum {
+	HAL_BLE_PHY_1M = 0,               /**< LE 1M (padrão) */
+	HAL_BLE_PHY_2M,                   /**< LE 2M: menos tempo de rádio por byte */
+	HAL_BLE_PHY_CODED,                /**< LE Coded (S2/S8): maior alcance */
+	HAL_BLE_PHY_COUNT,                /**< Número de PHYs */
+} hal_ble_phy_t;
+
+/**
+ * @brief Troca de PHY de uma conexão
+ */
+typedef struct {
+	uint8_t conn_id;                  /**< Índice da conexão */
+	hal_ble_phy_t phy;                /**< Novo PHY (transmissão) */
+	hal_ble_phy_t prev_phy;           /**< PHY anterior */
+	uint32_t prev_duration_ms;        /**< Tempo passado no PHY anterior (ms) */
+} hal_ble_phy_info_t;
+
+/**
+ * @brief Tempo acumulado de conexão em cada PHY
+ * 
+ * Soma o tempo de todas as conexões desde o boot, incluindo o trecho em
+ * andamento das conexões ativas.
+ */
+typedef struct {
+	uint32_t time_ms[HAL_BLE_PHY_COUNT]; /**< Tempo em cada PHY (ms) */
+	uint32_t switches;                /**< Trocas de PHY concluídas */
+} hal_ble_phy_stats_t;
+
 /**
  * @brief Informações de conexão
  */
@@ -73,8 +175,65 @@ typedef struct {
 	uint16_t interval_ms;             /**< Intervalo de conexão em ms */
 	uint16_t latency;                 /**< Latência de conexão (eventos) */
 	uint16_t timeout_ms;              /**< Timeout de supervisão em ms */
+	hal_ble_conn_profile_t profile;   /**< Perfil solicitado ao central */
+	uint8_t conn_id;                  /**< Índice da conexão (0 a CONFIG_BT_MAX_CONN - 1) */
+	bool primary;                     /**< Conexão principal (acompanha o dome) */
+	hal_ble_phy_t phy;                /**< PHY atual (transmissão) */
 } hal_ble_conn_info_t;
 
+/**
+ * @brief Bateria desconhecida no estado anunciado
+ */
+#define HAL_BLE_BATTERY_UNKNOWN 0xFF
+
+/**
+ * @brief Estado da coleira anunciado nos dados de fabricante
+ * 
+ * Vai no advertising (AD type 0xFF) junto do Company ID, do perfil do
+ * firmware (CONFIG_HAL_BLE_STATUS_PROFILE_ID) e de um número de sequência
+ * que muda a cada alteração do conteúdo:
+ * 
+ *   | Company ID (LE16) | Perfil | Sequência | Bateria (%) | Flags |
+ * 
+ * Flags: bit 0 = alarme tocando.
+ */
+typedef struct {
+	uint8_t battery_pct;              /**< Bateria (0-100%, HAL_BLE_BATTERY_UNKNOWN) */
+	bool alarm_active;                /**< Alarme (buzzer intermitente) tocando */
+} hal_ble_adv_status_t;
+
+/**
+ * @brief Amostra de RSSI da conexão
+ */
+typedef struct {
+	int8_t rssi_dbm;                  /**< RSSI em dBm */
+	uint8_t conn_id;                  /**< Conexão principal no momento da leitura */
+	uint32_t timestamp_ms;            /**< Instante da leitura (uptime em ms) */
+} hal_ble_rssi_sample_t;
+
+/**
+ * @brief Zonas de perda de percurso reportadas pelo controlador
+ */
+typedef enum {
+	HAL_BLE_PATH_LOSS_ZONE_NEAR = 0,  /**< Abaixo do limiar inferior */
+	HAL_BLE_PATH_LOSS_ZONE_MIDDLE,    /**< Entre os limiares */
+	HAL_BLE_PATH_LOSS_ZONE_FAR,       /**< Acima do limiar superior */
+} hal_ble_path_loss_zone_t;
+
+/**
+ * @brief Parâmetros do monitoramento de perda de percurso
+ * 
+ * A perda de percurso é a potência de transmissão do central menos o
+ * RSSI recebido. Cada limiar só é considerado cruzado depois de
+ * ultrapassado pela histerese.
+ */
+typedef struct {
+	uint8_t near_db;                  /**< Limiar inferior (dB) */
+	uint8_t far_db;                   /**< Limiar superior (dB, > near_db) */
+	uint8_t hysteresis_db;            /**< Histerese de cada limiar (dB) */
+	uint16_t min_events;              /**< Eventos de conexão na nova zona antes do aviso */
+} hal_ble_path_loss_params_t;
+
 /*******************************************************************************
  * CALLBACKS
  ******************************************************************************/
@@ -89,10 +248,51 @@ typedef void (*hal_ble_connected_cb_t)(const hal_ble_conn_info_t *conn_info);
 /**
  * @brief Callback chamado quando um dispositivo se desconecta
  * 
+ * Chamado para cada conexão encerrada; use hal_ble_get_conn_count() para
+ * saber se ainda restam conexões.
+ * 
  * @param reason Código do motivo da desconexão
  */
 typedef void (*hal_ble_disconnected_cb_t)(uint8_t reason);
 
+/**
+ * @brief Callback chamado quando o central altera os parâmetros da conexão
+ * 
+ * Reporta os parâmetros concedidos, que podem diferir do perfil
+ * solicitado se o central recusar a negociação.
+ * 
+ * @param conn_info Parâmetros atuais da conexão
+ */
+typedef void (*hal_ble_conn_params_cb_t)(const hal_ble_conn_info_t *conn_info);
+
+/**
+ * @brief Callback chamado a cada nova amostra de RSSI da conexão
+ * 
+ * Executado na work queue do sistema: não deve bloquear.
+ * 
+ * @param sample Amostra lida
+ */
+typedef void (*hal_ble_rssi_cb_t)(const hal_ble_rssi_sample_t *sample);
+
+/**
+ * @brief Callback chamado quando o controlador reporta uma troca de zona
+ * 
+ * Executado na thread RX do Bluetooth: não deve bloquear.
+ * 
+ * @param zone Nova zona
+ * @param path_loss_db Perda de percurso medida (dB)
+ */
+typedef void (*hal_ble_path_loss_cb_t)(hal_ble_path_loss_zone_t zone, uint8_t path_loss_db);
+
+/**
+ * @brief Callback chamado quando o PHY de uma conexão muda
+ * 
+ * Executado na thread RX do Bluetooth: não deve bloquear.
+ * 
+ * @param info Novo PHY e tempo passado no anterior
+ */
+typedef void (*hal_ble_phy_cb_t)(const hal_ble_phy_info_t *info);
+
 /**
  * @brief Callback chamado quando o advertising é iniciado
  */
@@ -113,6 +313,8 @@ typedef struct {
 	hal_ble_disconnected_cb_t disconnected; /**< Callback de desconexão */
 	hal_ble_adv_started_cb_t adv_started;   /**< Callback advertising iniciado */
 	hal_ble_adv_stopped_cb_t adv_stopped;   /**< Callback advertising parado */
+	hal_ble_conn_params_cb_t conn_params_updated; /**< Callback parâmetros alterados */
+	hal_ble_phy_cb_t phy_updated;           /**< Callback troca de PHY */
 } hal_ble_callbacks_t;
 
 /*******************************************************************************
@@ -125,7 +327,8 @@ typedef struct {
  * Inicializa o stack Bluetooth, configura os serviços GATT e prepara
  * o sistema para advertising e conexões.
  * 
- * @param device_name Nome do dispositivo para advertising (máx 29 caracteres)
+ * @param device_name Nome do dispositivo para advertising (máx 29 caracteres;
+ *                    abreviado no advertising legado quando não cabe no PDU)
  * @param callbacks Estrutura de callbacks para eventos BLE (pode ser NULL)
  * 
  * @return HAL_BLE_SUCCESS em caso de sucesso
@@ -138,12 +341,18 @@ int hal_ble_init(const char *device_name, const hal_ble_callbacks_t *callbacks);
  * @brief Inicia o advertising (anúncio Bluetooth)
  * 
  * Torna o dispositivo visível e conectável para outros dispositivos BLE.
- * Use parâmetros padrão se adv_params for NULL.
+ * O advertising é retomado a cada conexão enquanto houver vaga para
+ * outra (CONFIG_BT_MAX_CONN), já no último estágio do cronograma.
+ * Use parâmetros padrão se adv_params for NULL. Os parâmetros (e o
+ * cronograma, se houver) são mantidos para os reinícios automáticos após
+ * uma desconexão. A troca de estágio reinicia o advertising com o novo
+ * intervalo.
  * 
  * @param adv_params Parâmetros de advertising (NULL usa valores padrão)
  * 
  * @return HAL_BLE_SUCCESS em caso de sucesso
- * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado ou todas as
+ *         conexões estão ocupadas
  * @return HAL_BLE_ERROR_FAILED se falhar ao iniciar advertising
  */
 int hal_ble_start_advertising(const hal_ble_adv_params_t *adv_params);
@@ -159,9 +368,9 @@ int hal_ble_start_advertising(const hal_ble_adv_params_t *adv_params);
 int hal_ble_stop_advertising(void);
 
 /**
- * @brief Desconecta do dispositivo conectado
+ * @brief Desconecta todos os dispositivos conectados
  * 
- * Encerra a conexão BLE atual e retorna ao modo pronto.
+ * Encerra as conexões BLE ativas e retorna ao modo pronto.
  * 
  * @return HAL_BLE_SUCCESS em caso de sucesso
  * @return HAL_BLE_ERROR_NOT_CONNECTED se não há conexão ativa
@@ -183,6 +392,270 @@ hal_ble_state_t hal_ble_get_state(void);
  */
 bool hal_ble_is_connected(void);
 
+/**
+ * @brief Retorna o número de conexões ativas
+ * 
+ * @return Conexões ativas (0 a CONFIG_BT_MAX_CONN)
+ */
+uint8_t hal_ble_get_conn_count(void);
+
+/**
+ * @brief Define o perfil de parâmetros de conexão
+ * 
+ * O perfil vale para a conexão principal, atual e futura; as demais
+ * conexões ficam sempre no perfil IDLE. Com uma conexão ativa, a
+ * negociação é feita em segundo plano: ALERT é solicitado imediatamente;
+ * IDLE aguarda a acomodação da descoberta de serviços.
+ * Se o central recusar, a solicitação é repetida a cada
+ * CONFIG_HAL_BLE_CONN_PARAM_RETRY_MS, até CONFIG_HAL_BLE_CONN_PARAM_RETRIES
+ * vezes.
+ * 
+ * @param profile Perfil desejado
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado
+ * @return HAL_BLE_ERROR_INVALID se o perfil for inválido
+ */
+int hal_ble_set_conn_profile(hal_ble_conn_profile_t profile);
+
+/**
+ * @brief Retorna o perfil de parâmetros de conexão solicitado
+ * 
+ * @return Perfil atual
+ */
+hal_ble_conn_profile_t hal_ble_get_conn_profile(void);
+
+/**
+ * @brief Obtém os parâmetros concedidos para a conexão principal
+ * 
+ * @param conn_info Ponteiro para estrutura onde os parâmetros serão armazenados
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_INVALID se conn_info for NULL
+ * @return HAL_BLE_ERROR_NOT_CONNECTED se não há conexão ativa
+ */
+int hal_ble_get_conn_info(hal_ble_conn_info_t *conn_info);
+
+/**
+ * @brief Define o intervalo da amostragem de RSSI da conexão
+ * 
+ * O RSSI da conexão principal é lido com o comando HCI Read RSSI enquanto
+ * houver uma conexão ativa. O controlador só atualiza o valor nos eventos
+ * de conexão: intervalos menores que o intervalo de conexão repetem a
+ * leitura. O padrão é CONFIG_HAL_BLE_RSSI_INTERVAL_MS.
+ * 
+ * @param interval_ms Intervalo em ms (0 desativa, mínimo 100)
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado
+ * @return HAL_BLE_ERROR_INVALID se o intervalo estiver abaixo do mínimo
+ */
+int hal_ble_set_rssi_interval(uint32_t interval_ms);
+
+/**
+ * @brief Obtém a amostra de RSSI mais recente da conexão principal
+ * 
+ * Não dispara leitura: retorna o resultado da última amostragem.
+ * 
+ * @param sample Ponteiro para estrutura onde a amostra será armazenada
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_INVALID se sample for NULL
+ * @return HAL_BLE_ERROR_NOT_CONNECTED se não há conexão ativa
+ * @return HAL_BLE_ERROR_STATE se ainda não há amostra da conexão principal
+ */
+int hal_ble_get_rssi(hal_ble_rssi_sample_t *sample);
+
+/**
+ * @brief Retira a amostra de RSSI mais antiga da fila
+ * 
+ * A fila (CONFIG_HAL_BLE_RSSI_RING_SIZE amostras) não usa locks e admite
+ * um único consumidor: apenas uma thread deve chamar esta função. Com a
+ * fila cheia, as amostras novas são descartadas até o consumidor ler as
+ * antigas. A fila não é esvaziada entre conexões; use conn_id e o
+ * timestamp para separá-las.
+ * 
+ * @param sample Ponteiro para estrutura onde a amostra será armazenada
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_INVALID se sample for NULL
+ * @return HAL_BLE_ERROR_STATE se a fila estiver vazia
+ */
+int hal_ble_rssi_pop(hal_ble_rssi_sample_t *sample);
+
+/**
+ * @brief Registra um callback para as amostras de RSSI
+ * 
+ * @param cb Função a ser chamada a cada amostra
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_INVALID se cb for NULL
+ * @return HAL_BLE_ERROR_STATE se não houver espaço para novos callbacks
+ */
+int hal_ble_register_rssi_cb(hal_ble_rssi_cb_t cb);
+
+/**
+ * @brief Configura o monitoramento de perda de percurso pelo controlador
+ * 
+ * Com CONFIG_BT_PATH_LOSS_MONITORING e um controlador com suporte a LE
+ * Power Control, o controlador compara a perda de percurso com os
+ * limiares a cada evento de conexão e só acorda a aplicação nas trocas
+ * de zona; a amostragem periódica de RSSI fica suspensa. Sem suporte (ou
+ * se o controlador reportar a perda de percurso como indisponível), a
+ * amostragem de RSSI é mantida como alternativa.
+ * 
+ * Vale para a conexão principal, atual e futura.
+ * 
+ * @param params Limiares (ignorado se cb for NULL)
+ * @param cb Callback de troca de zona (NULL desativa o monitoramento)
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado
+ * @return HAL_BLE_ERROR_INVALID se os limiares forem inválidos
+ */
+int hal_ble_set_path_loss_monitor(const hal_ble_path_loss_params_t *params,
+                                  hal_ble_path_loss_cb_t cb);
+
+/**
+ * @brief Verifica se a conexão principal é monitorada pelo controlador
+ * 
+ * @return true se a perda de percurso é monitorada pelo controlador
+ * @return false se não há conexão ou se a amostragem de RSSI está em uso
+ */
+bool hal_ble_is_path_loss_active(void);
+
+/**
+ * @brief Sinaliza uma transferência em massa pendente
+ * 
+ * Com CONFIG_HAL_BLE_PHY_MANAGER, as conexões passam ao PHY 2M enquanto
+ * houver alguma transferência em massa pendente (ex.: download do
+ * histórico), encurtando o tempo de rádio ligado, e voltam ao PHY
+ * anterior ao fim. A conexão principal na borda do dome continua no LE
+ * Coded. As chamadas são contadas: cada início deve ter o seu fim.
+ * 
+ * @param active true no início da transferência, false no fim
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado ou se não há
+ *         transferência para encerrar
+ */
+int hal_ble_set_bulk_transfer(bool active);
+
+/**
+ * @brief Obtém o tempo acumulado de conexão em cada PHY
+ * 
+ * @param stats Ponteiro para estrutura onde a estatística será armazenada
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_INVALID se stats for NULL
+ */
+int hal_ble_get_phy_stats(hal_ble_phy_stats_t *stats);
+
+/**
+ * @brief Atualiza o estado da coleira anunciado no advertising
+ * 
+ * Os dados de fabricante são trocados com o advertising em andamento
+ * (bt_le_adv_update_data()), sem pará-lo, na work queue do sistema.
+ * Aplicativos que só escaneiam leem bateria e alarme sem se conectar.
+ * Chamadas que não alteram o conteúdo não mudam a sequência nem o
+ * advertising. Pode ser chamada de qualquer contexto de thread.
+ * 
+ * O alarme também liga o piso de potência do controle adaptativo
+ * (CONFIG_HAL_BLE_TX_POWER_CONTROL).
+ * 
+ * @param status Estado a anunciar
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado
+ * @return HAL_BLE_ERROR_INVALID se status for NULL ou a bateria for
+ *         maior que 100% (e diferente de HAL_BLE_BATTERY_UNKNOWN)
+ */
+int hal_ble_set_adv_status(const hal_ble_adv_status_t *status);
+
+/**
+ * @brief Inicia (ou reconfigura) o trem de advertising periódico
+ * 
+ * Um conjunto de advertising estendido, não conectável e separado do
+ * advertising de conexão, leva a sync info de um advertising periódico
+ * com o estado da coleira (mesmo registro de hal_ble_adv_status_t).
+ * Observadores (celulares, base) sincronizam uma vez e recebem cada
+ * atualização na cadência conhecida, com o rádio de recepção ligado só
+ * nos instantes do trem; o custo na coleira não cresce com o número de
+ * observadores. O trem segue ativo com ou sem conexões.
+ * 
+ * Requer CONFIG_HAL_BLE_PERIODIC_ADV. Aplicado de forma assíncrona.
+ * 
+ * @param interval_ms Intervalo do trem (8 a 81910 ms, 0 = padrão do Kconfig)
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado ou o advertising
+ *         periódico está desabilitado no build
+ * @return HAL_BLE_ERROR_INVALID se o intervalo estiver fora dos limites
+ */
+int hal_ble_start_periodic_adv(uint32_t interval_ms);
+
+/**
+ * @brief Para o trem de advertising periódico
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado ou o advertising
+ *         periódico está desabilitado no build
+ */
+int hal_ble_stop_periodic_adv(void);
+
+/**
+ * @brief Inicia (ou reconfigura) o beacon não conectável
+ * 
+ * Um conjunto de advertising estendido com PDUs legados não conectáveis
+ * anuncia nome, TX Power Level e o estado da coleira, ao lado do
+ * advertising de conexão. O aplicativo de radar acompanha o RSSI em
+ * uma cadência alta sem que o advertising de conexão precise ser
+ * rápido: o beacon não abre janela de recepção após cada pacote. O
+ * beacon segue ativo com ou sem conexões.
+ * 
+ * Requer CONFIG_HAL_BLE_BEACON. Aplicado de forma assíncrona.
+ * 
+ * @param params Intervalo e potência (NULL = valores atuais, inicialmente
+ *               os do Kconfig)
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado ou o beacon
+ *         está desabilitado no build
+ * @return HAL_BLE_ERROR_INVALID se os parâmetros estiverem fora dos limites
+ */
+int hal_ble_start_beacon(const hal_ble_beacon_params_t *params);
+
+/**
+ * @brief Para o beacon não conectável
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado ou o beacon
+ *         está desabilitado no build
+ */
+int hal_ble_stop_beacon(void);
+
+/**
+ * @brief Define a potência de transmissão de um conjunto de advertising
+ * 
+ * Aplicada sem parar o conjunto, ou no próximo início. O controlador
+ * escolhe o nível suportado mais próximo abaixo do pedido. Requer
+ * CONFIG_BT_CTLR_TX_PWR_DYNAMIC_CONTROL; sem ele, o valor é guardado e o
+ * controlador mantém a potência padrão.
+ * 
+ * Com CONFIG_HAL_BLE_TX_POWER_CONTROL, o beacon desce até a potência da
+ * conexão principal enquanto houver uma, e durante o alarme nenhum
+ * conjunto fica abaixo de CONFIG_HAL_BLE_TX_POWER_ALARM_FLOOR_DBM.
+ * 
+ * @param set Conjunto de advertising
+ * @param tx_power_dbm Potência pedida (-40 a +8 dBm)
+ * 
+ * @return HAL_BLE_SUCCESS em caso de sucesso
+ * @return HAL_BLE_ERROR_STATE se BLE não foi inicializado
+ * @return HAL_BLE_ERROR_INVALID se a potência estiver fora dos limites ou
+ *         o conjunto não existir no build
+ */
+int hal_ble_set_adv_tx_power(hal_ble_adv_set_t set, int8_t tx_power_dbm);
+
 
 #ifdef __cplusplus
 }
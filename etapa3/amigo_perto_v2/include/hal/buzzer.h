@@ -13,6 +13,8 @@
  * Funcionalidades:
  * - Inicialização do subsistema de buzzer
  * - Controle intermitente liga/desliga com diferentes intensidades
+ * - Aviso de carga ativa (PWM ligado) para medições sob carga
+ * - Arbitragem entre as fontes de alarme (app, IAS, Link Loss, dome)
  */
 
 #ifndef HAL_BUZZER_H_
@@ -46,6 +48,43 @@ typedef enum {
 	HAL_BUZZER_INTENSITY_MAX = 100,  /**< Máxima intensidade (100%) */
 } hal_buzzer_intensity_t;
 
+/**
+ * @brief Fontes que podem pedir o alarme
+ * 
+ * Cada fonte liga e desliga apenas o próprio pedido: o buzzer toca
+ * enquanto houver ao menos uma fonte ativa, na maior intensidade pedida.
+ */
+typedef enum {
+	HAL_BUZZER_SOURCE_APP = 0,       /**< Característica do Buzzer Service */
+	HAL_BUZZER_SOURCE_IMMEDIATE,     /**< Immediate Alert Service */
+	HAL_BUZZER_SOURCE_LINK_LOSS,     /**< Link Loss Service */
+	HAL_BUZZER_SOURCE_PROXIMITY,     /**< Saída do dome virtual */
+	HAL_BUZZER_SOURCE_COUNT,
+} hal_buzzer_source_t;
+
+/**
+ * @brief Callback chamado quando o PWM do buzzer liga ou desliga
+ * 
+ * Executado na work queue do sistema, a cada transição do PWM, inclusive
+ * no desligamento pedido por hal_buzzer_set_intermittent(false). Permite
+ * que outros módulos (ex.: HAL Battery) meçam grandezas sob a carga do
+ * buzzer. Não deve bloquear.
+ * 
+ * @param active true quando o PWM passa a conduzir, false quando desliga
+ */
+typedef void (*hal_buzzer_load_cb_t)(bool active);
+
+/**
+ * @brief Callback chamado quando o alarme (padrão intermitente) liga ou desliga
+ * 
+ * Diferente do callback de carga, não acompanha cada ciclo do padrão.
+ * Executado no contexto de quem chamou hal_buzzer_set_intermittent():
+ * não deve bloquear.
+ * 
+ * @param active true quando o alarme passa a tocar, false quando para
+ */
+typedef void (*hal_buzzer_state_cb_t)(bool active);
+
 /**
  * @brief Inicializa o subsistema de buzzer
  * 
@@ -71,6 +110,48 @@ int hal_buzzer_init(void);
  */
 int hal_buzzer_set_intermittent(bool active, uint8_t intensity);
 
+/**
+ * @brief Liga/desliga o pedido de alarme de uma fonte
+ * 
+ * O padrão intermitente segue o conjunto de fontes ativas: liga com o
+ * primeiro pedido, acompanha a maior intensidade pedida e só desliga
+ * quando nenhuma fonte quer o alarme. Pode ser chamada de qualquer thread.
+ * 
+ * @param source Fonte do pedido
+ * @param active true para pedir o alarme, false para retirar o pedido
+ * @param intensity Intensidade pedida (1-100; ignorada ao retirar)
+ * 
+ * @return HAL_BUZZER_SUCCESS em caso de sucesso
+ * @return HAL_BUZZER_ERROR_INVALID se fonte ou intensidade inválidas
+ * @return HAL_BUZZER_ERROR_STATE se buzzer não foi inicializado
+ */
+int hal_buzzer_set_alarm(hal_buzzer_source_t source, bool active, uint8_t intensity);
+
+/**
+ * @brief Registra o callback de transição de carga do PWM
+ * 
+ * @param cb Função chamada a cada transição do PWM (NULL remove)
+ * 
+ * @return HAL_BUZZER_SUCCESS em caso de sucesso
+ */
+int hal_buzzer_set_load_callback(hal_buzzer_load_cb_t cb);
+
+/**
+ * @brief Registra o callback de início e fim do alarme
+ * 
+ * @param cb Função chamada quando o padrão intermitente liga ou desliga (NULL remove)
+ * 
+ * @return HAL_BUZZER_SUCCESS em caso de sucesso
+ */
+int hal_buzzer_set_state_callback(hal_buzzer_state_cb_t cb);
+
+/**
+ * @brief Verifica se o alarme (padrão intermitente) está ativo
+ * 
+ * @return true se o buzzer intermitente está ligado
+ */
+bool hal_buzzer_is_active(void);
+
 
 #ifdef __cplusplus
 }
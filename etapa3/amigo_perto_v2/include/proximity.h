@@ -0,0 +1,140 @@
+/*
+ * Proximity - Motor de proximidade (dome virtual)
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+/**
+ * @file proximity.h
+ * @brief Estimativa de distância pelo RSSI da conexão e alarme do dome virtual
+ * 
+ * Este módulo consome as amostras de RSSI do HAL BLE, estima a distância
+ * entre a coleira e o tutor e aciona o buzzer localmente quando o cão sai
+ * do raio configurado, sem depender do celular.
+ * 
+ * Funcionalidades:
+ * - Filtro de mediana (5 amostras) seguido de média móvel exponencial em
+ *   ponto fixo (Q8)
+ * - Distância pelo modelo log-distância, com tabela pré-calculada de
+ *   potências de 10 (sem ponto flutuante)
+ * - Histerese de distância e de tempo de permanência (dwell) para trocar
+ *   de zona
+ * - Com LE Power Control, limiares de perda de percurso monitorados pelo
+ *   controlador em vez da amostragem de RSSI
+ * - Acionamento direto do HAL Buzzer
+ */
+
+#ifndef PROXIMITY_H_
+#define PROXIMITY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * DEFINIÇÕES E TIPOS
+ ******************************************************************************/
+
+/**
+ * @brief Códigos de erro do motor de proximidade
+ */
+typedef enum {
+	PROXIMITY_SUCCESS = 0,            /**< Operação bem-sucedida */
+	PROXIMITY_ERROR_INVALID = -1,     /**< Parâmetro inválido */
+	PROXIMITY_ERROR_STATE = -2,       /**< Estado inválido */
+} proximity_error_t;
+
+/**
+ * @brief Zona do cão em relação ao dome virtual
+ */
+typedef enum {
+	PROXIMITY_ZONE_UNKNOWN = 0,       /**< Sem amostras suficientes */
+	PROXIMITY_ZONE_INSIDE,            /**< Dentro do raio */
+	PROXIMITY_ZONE_OUTSIDE,           /**< Fora do raio: alarme acionado */
+} proximity_zone_t;
+
+/**
+ * @brief Callback chamado a cada troca de zona
+ * 
+ * Executado na work queue do sistema, depois que o buzzer já foi
+ * acionado ou desligado. Não deve bloquear.
+ * 
+ * @param zone Nova zona
+ * @param distance_cm Distância estimada no momento da troca (cm)
+ */
+typedef void (*proximity_zone_cb_t)(proximity_zone_t zone, uint32_t distance_cm);
+
+/*******************************************************************************
+ * API PÚBLICA
+ ******************************************************************************/
+
+/**
+ * @brief Inicializa o motor de proximidade
+ * 
+ * Assina as amostras de RSSI do HAL BLE. Deve ser chamada depois de
+ * hal_ble_init() e hal_buzzer_init().
+ * 
+ * @param zone_cb Callback de troca de zona (pode ser NULL)
+ * 
+ * @return PROXIMITY_SUCCESS em caso de sucesso
+ * @return PROXIMITY_ERROR_STATE se não foi possível assinar o RSSI
+ */
+int proximity_init(proximity_zone_cb_t zone_cb);
+
+/**
+ * @brief Define o raio do dome virtual
+ * 
+ * O cão é considerado fora ao ultrapassar o raio e de volta ao ficar
+ * abaixo do raio menos CONFIG_PROXIMITY_HYSTERESIS_CM.
+ * 
+ * @param radius_cm Raio em cm
+ * 
+ * @return PROXIMITY_SUCCESS em caso de sucesso
+ * @return PROXIMITY_ERROR_INVALID se o raio não for maior que a histerese
+ */
+int proximity_set_radius(uint32_t radius_cm);
+
+/**
+ * @brief Retorna o raio do dome virtual
+ * 
+ * @return Raio em cm
+ */
+uint32_t proximity_get_radius(void);
+
+/**
+ * @brief Descarta o histórico dos filtros e a zona atual
+ * 
+ * Deve ser chamada ao fim de uma conexão: o RSSI da próxima conexão não
+ * tem relação com o da anterior. Retira o pedido de alarme do dome; o
+ * buzzer só para se nenhuma outra fonte (ex.: Link Loss) o quiser.
+ */
+void proximity_reset(void);
+
+/**
+ * @brief Retorna a zona atual
+ * 
+ * @return Zona atual
+ */
+proximity_zone_t proximity_get_zone(void);
+
+/**
+ * @brief Obtém a distância estimada pelo último RSSI filtrado
+ * 
+ * @param distance_cm Ponteiro para armazenar a distância em cm
+ * 
+ * @return PROXIMITY_SUCCESS em caso de sucesso
+ * @return PROXIMITY_ERROR_INVALID se distance_cm for NULL
+ * @return PROXIMITY_ERROR_STATE se ainda não há estimativa
+ */
+int proximity_get_distance(uint32_t *distance_cm);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROXIMITY_H_ */
@@ -13,6 +13,29 @@
  * - Battery Level (0x2A19) - Padrão Bluetooth SIG (Read + Notify)
  * - Battery Voltage (custom 128-bit UUID) - Tensão em mV (Read)
  * - Battery State (custom 128-bit UUID) - Estado da bateria (Read)
+ * - Battery Status (custom 128-bit UUID) - Nível, tensão, estado, idade e
+ *   sequência da amostra em um único PDU (Read + Notify)
+ * - Battery History (custom 128-bit UUID) - Download do histórico de tensão
+ *   em rajadas de notificações do tamanho do MTU (Write + Notify), no PHY
+ *   2M quando o central aceita
+ * - Battery Forecast (custom 128-bit UUID) - Dias restantes até bateria
+ *   crítica, estimados pela tendência de tensão (Read)
+ * 
+ * As leituras usam o snapshot em cache do HAL Battery, de modo que os
+ * callbacks executados na thread RX do Bluetooth nunca disparam o ADC.
+ * 
+ * Notificações de Battery Level são orientadas a mudanças: a cada
+ * amostragem periódica do HAL, uma notificação só é enviada se o
+ * percentual se afastar do último valor notificado por mais que a banda
+ * de histerese, ou se o estado da bateria mudar. Rajadas são limitadas
+ * a uma notificação por intervalo mínimo, coalescendo para o valor mais
+ * recente. O evento de bateria crítica do HAL (comparador POF) é
+ * notificado imediatamente, sem aguardar o intervalo mínimo.
+ * 
+ * Com vários celulares conectados, cada notificação é enviada uma única
+ * vez pelo stack a todas as conexões inscritas (o estado de inscrição de
+ * cada conexão fica no CCC). O download do histórico atende uma conexão
+ * por vez.
  * 
  * Copyright (c) 2025
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
@@ -20,6 +43,9 @@
 
 #include "gatt/battery_service.h"
 #include "hal/battery.h"
+#include "hal/battery_history.h"
+#include "hal/battery_forecast.h"
+#include "hal/ble.h"
 
 // Zephyr includes
 #include <zephyr/kernel.h>
@@ -28,6 +54,7 @@
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/conn.h>
+#include <zephyr/sys/byteorder.h>
 
 // Registra módulo de logging
 LOG_MODULE_REGISTER(gatt_battery, LOG_LEVEL_DBG);
@@ -51,6 +78,116 @@ LOG_MODULE_REGISTER(gatt_battery, LOG_LEVEL_DBG);
 #define BT_UUID_BATTERY_STATE \
 	BT_UUID_DECLARE_128(BT_UUID_BATTERY_STATE_VAL)
 
+#define BT_UUID_BATTERY_STATUS_VAL \
+	BT_UUID_128_ENCODE(0x00001003, 0x8e22, 0x4541, 0x9d4c, 0x21edae82ed19)
+#define BT_UUID_BATTERY_STATUS \
+	BT_UUID_DECLARE_128(BT_UUID_BATTERY_STATUS_VAL)
+
+#define BT_UUID_BATTERY_HISTORY_VAL \
+	BT_UUID_128_ENCODE(0x00001004, 0x8e22, 0x4541, 0x9d4c, 0x21edae82ed19)
+#define BT_UUID_BATTERY_HISTORY \
+	BT_UUID_DECLARE_128(BT_UUID_BATTERY_HISTORY_VAL)
+
+#define BT_UUID_BATTERY_FORECAST_VAL \
+	BT_UUID_128_ENCODE(0x00001005, 0x8e22, 0x4541, 0x9d4c, 0x21edae82ed19)
+#define BT_UUID_BATTERY_FORECAST \
+	BT_UUID_DECLARE_128(BT_UUID_BATTERY_FORECAST_VAL)
+
+/*******************************************************************************
+ * DEFINIÇÕES DE TIPOS
+ ******************************************************************************/
+
+/**
+ * @brief PDU da característica Battery Status (little-endian, 12 bytes)
+ * 
+ * Cabe em um único ATT PDU mesmo com o MTU padrão (23 bytes).
+ */
+struct battery_status_pdu {
+	uint8_t level;                    /**< Percentual (0-100%) */
+	uint16_t voltage_mv;              /**< Tensão em mV */
+	uint8_t state;                    /**< hal_battery_state_t */
+	uint32_t age_ms;                  /**< Idade da amostra em ms */
+	uint32_t sequence;                /**< Número de sequência da amostra */
+} __packed;
+
+/**
+ * @brief Cabeçalho do download do histórico (little-endian, 13 bytes)
+ */
+struct battery_history_header_pdu {
+	uint8_t type;                     /**< HISTORY_PKT_HEADER */
+	uint8_t version;                  /**< Versão do formato */
+	uint16_t interval_s;              /**< Cadência das amostras (s) */
+	uint8_t resolution_mv;            /**< Unidade dos deltas (mV) */
+	uint32_t first_seq;               /**< Sequência da primeira amostra */
+	uint16_t count;                   /**< Número de amostras */
+	uint16_t first_mv;                /**< Tensão absoluta da primeira amostra */
+} __packed;
+
+/**
+ * @brief PDU da característica Battery Forecast (little-endian, 12 bytes)
+ * 
+ * days_remaining = 0xFFFF quando não há previsão (tensão estável ou
+ * amostras insuficientes; ver samples).
+ */
+struct battery_forecast_pdu {
+	uint16_t days_remaining;          /**< Dias até o estado crítico */
+	int32_t slope_uv_per_day;         /**< Tendência da tensão (uV/dia) */
+	uint16_t fitted_mv;               /**< Tensão em repouso atual segundo a reta ajustada */
+	uint16_t critical_mv;             /**< Limiar crítico na mesma escala de fitted_mv */
+	uint16_t samples;                 /**< Amostras na janela de regressão */
+} __packed;
+
+// Índices dos atributos em battery_svc usados para notificação
+#define BATTERY_LEVEL_ATTR_IDX   1
+#define BATTERY_STATUS_ATTR_IDX  8
+#define BATTERY_HISTORY_ATTR_IDX 11
+
+// Comandos escritos na característica Battery History
+#define HISTORY_CMD_ABORT        0x00
+#define HISTORY_CMD_START        0x01
+
+// Tipos de pacote notificados pela característica Battery History
+// DATA: [tipo][u16 índice do bloco][deltas int8...]
+// END:  [tipo][status]
+#define HISTORY_PKT_HEADER       0x00
+#define HISTORY_PKT_DATA         0x01
+#define HISTORY_PKT_END          0x02
+#define HISTORY_PKT_DATA_HDR_LEN 3
+
+#define HISTORY_FORMAT_VERSION   1
+
+// Status do pacote END
+#define HISTORY_STATUS_OK          0x00
+#define HISTORY_STATUS_OVERWRITTEN 0x01
+#define HISTORY_STATUS_ABORTED     0x02
+
+// Controle de fluxo do download
+#define HISTORY_PKT_MAX          244   /**< Maior payload de notificação (MTU 247) */
+#define HISTORY_DUMP_WINDOW      4     /**< Notificações em trânsito simultâneas */
+#define HISTORY_DUMP_RETRY_MS    20    /**< Nova tentativa quando sem buffers */
+
+/**
+ * @brief Etapas do download do histórico
+ */
+enum history_dump_stage {
+	DUMP_IDLE = 0,
+	DUMP_HEADER,
+	DUMP_DATA,
+	DUMP_END,
+};
+
+/**
+ * @brief Bits de history_dump.flags
+ * 
+ * As escritas e a desconexão chegam na thread RX do Bluetooth; só postam
+ * pedidos, e o estado do download é alterado apenas no work item.
+ */
+enum history_dump_flag {
+	DUMP_FLAG_BUSY = 0,   /**< Download reservado (START aceito, até o fim) */
+	DUMP_FLAG_START,      /**< START pendente (conexão em req_conn) */
+	DUMP_FLAG_ABORT,      /**< ABORT pendente */
+};
+
 /*******************************************************************************
  * VARIÁVEIS PRIVADAS
  ******************************************************************************/
@@ -63,16 +200,81 @@ static uint8_t battery_level = 0;      // Percentual (0-100%)
 static uint16_t battery_voltage = 0;   // Tensão em mV
 static uint8_t battery_state = 0;      // Estado (0-4)
 
-// Conexão atual para notificações
-static struct bt_conn *current_conn = NULL;
-
-// Flag de notificação habilitada
+// Flags de notificação habilitada (alguma conexão inscrita, conforme o
+// valor agregado do CCC mantido pelo stack)
 static bool notify_enabled = false;
+static bool status_notify_enabled = false;
+
+// Motor de notificação orientado a mudanças
+#define LEVEL_NOT_NOTIFIED 0xFF
+static uint8_t last_notified_level = LEVEL_NOT_NOTIFIED;
+static uint8_t last_notified_state = HAL_BATTERY_STATE_UNKNOWN;
+static int64_t last_notify_ms = 0;
+
+// Work item para envio coalescido ao fim da janela de rate limit
+static struct k_work_delayable notify_work;
+
+// Download do histórico em andamento
+static bool history_notify_enabled = false;
+static struct k_work_delayable history_dump_work;
+static struct {
+	struct bt_conn *conn;             /**< Conexão que solicitou o download */
+	struct bt_conn *req_conn;         /**< Conexão do START pendente */
+	atomic_t flags;                   /**< Pedidos da thread RX (DUMP_FLAG_*) */
+	atomic_t gen;                     /**< Geração: descarta callbacks de downloads anteriores */
+	enum history_dump_stage stage;
+	hal_battery_history_info_t info;  /**< Trecho sendo enviado */
+	uint32_t next_seq;                /**< Próxima amostra a enviar */
+	uint16_t chunk;                   /**< Índice do próximo bloco DATA */
+	uint8_t status;                   /**< Status informado no pacote END */
+	atomic_t inflight;                /**< Notificações aguardando envio */
+} history_dump;
 
 /*******************************************************************************
  * FUNÇÕES DE LEITURA DAS CARACTERÍSTICAS
  ******************************************************************************/
 
+/**
+ * @brief Obtém o snapshot da bateria sem bloquear
+ * 
+ * Um snapshot desatualizado ainda é usado (o HAL agenda uma nova
+ * amostragem em segundo plano); apenas a ausência de dados é erro.
+ */
+static int get_battery_snapshot(hal_battery_info_t *info)
+{
+	int err = hal_battery_get_cached(info, CONFIG_HAL_BATTERY_CACHE_MAX_AGE_MS);
+	
+	if (err == HAL_BATTERY_ERROR_STALE) {
+		LOG_DBG("Snapshot de bateria desatualizado, usando último valor");
+		return HAL_BATTERY_SUCCESS;
+	}
+	
+	return err;
+}
+
+/**
+ * @brief Monta o PDU de Battery Status a partir de um único snapshot
+ */
+static int build_status_pdu(struct battery_status_pdu *pdu)
+{
+	hal_battery_snapshot_t snapshot;
+	int err = hal_battery_get_snapshot(&snapshot, CONFIG_HAL_BATTERY_CACHE_MAX_AGE_MS);
+	
+	if (err != HAL_BATTERY_SUCCESS && err != HAL_BATTERY_ERROR_STALE) {
+		return err;
+	}
+	
+	int64_t age_ms = k_uptime_get() - snapshot.timestamp_ms;
+	
+	pdu->level = snapshot.info.percentage;
+	pdu->voltage_mv = sys_cpu_to_le16(snapshot.info.voltage_mv);
+	pdu->state = (uint8_t)snapshot.info.state;
+	pdu->age_ms = sys_cpu_to_le32((uint32_t)MIN(age_ms, (int64_t)UINT32_MAX));
+	pdu->sequence = sys_cpu_to_le32(snapshot.sequence);
+	
+	return 0;
+}
+
 /**
  * @brief Lê o nível da bateria (padrão Bluetooth)
  */
@@ -80,16 +282,16 @@ static ssize_t read_battery_level(struct bt_conn *conn,
                                    const struct bt_gatt_attr *attr,
                                    void *buf, uint16_t len, uint16_t offset)
 {
-	// Atualiza valor lendo do HAL
+	// Atualiza valor a partir do snapshot em cache
 	hal_battery_info_t info;
-	int err = hal_battery_get_info(&info);
+	int err = get_battery_snapshot(&info);
 	
 	if (err == HAL_BATTERY_SUCCESS) {
 		battery_level = info.percentage;
 		LOG_DBG("Leitura Battery Level: %d%%", battery_level);
 		
-		// Notifica aplicação
-		if (app_callbacks && app_callbacks->battery_read_cb) {
+		// Notifica aplicação (apenas uma vez por leitura, não por blob)
+		if (offset == 0 && app_callbacks && app_callbacks->battery_read_cb) {
 			app_callbacks->battery_read_cb(battery_level);
 		}
 	} else {
@@ -107,9 +309,9 @@ static ssize_t read_battery_voltage(struct bt_conn *conn,
                                      const struct bt_gatt_attr *attr,
                                      void *buf, uint16_t len, uint16_t offset)
 {
-	// Atualiza valor lendo do HAL
+	// Atualiza valor a partir do snapshot em cache
 	hal_battery_info_t info;
-	int err = hal_battery_get_info(&info);
+	int err = get_battery_snapshot(&info);
 	
 	if (err == HAL_BATTERY_SUCCESS) {
 		battery_voltage = info.voltage_mv;
@@ -129,9 +331,9 @@ static ssize_t read_battery_state(struct bt_conn *conn,
                                    const struct bt_gatt_attr *attr,
                                    void *buf, uint16_t len, uint16_t offset)
 {
-	// Atualiza valor lendo do HAL
+	// Atualiza valor a partir do snapshot em cache
 	hal_battery_info_t info;
-	int err = hal_battery_get_info(&info);
+	int err = get_battery_snapshot(&info);
 	
 	if (err == HAL_BATTERY_SUCCESS) {
 		battery_state = (uint8_t)info.state;
@@ -144,6 +346,250 @@ static ssize_t read_battery_state(struct bt_conn *conn,
 	                         &battery_state, sizeof(battery_state));
 }
 
+/**
+ * @brief Lê o status completo da bateria em um único PDU (customizado)
+ */
+static ssize_t read_battery_status(struct bt_conn *conn,
+                                    const struct bt_gatt_attr *attr,
+                                    void *buf, uint16_t len, uint16_t offset)
+{
+	struct battery_status_pdu pdu = {0};
+	int err = build_status_pdu(&pdu);
+	
+	if (err) {
+		LOG_ERR("Erro ao ler status da bateria (err %d)", err);
+	} else {
+		LOG_DBG("Leitura Battery Status: %d%%, %d mV, estado %d",
+		        pdu.level, sys_le16_to_cpu(pdu.voltage_mv), pdu.state);
+	}
+	
+	return bt_gatt_attr_read(conn, attr, buf, len, offset,
+	                         &pdu, sizeof(pdu));
+}
+
+/**
+ * @brief Callback de leitura da característica Battery Forecast
+ */
+static ssize_t read_battery_forecast(struct bt_conn *conn,
+                                      const struct bt_gatt_attr *attr,
+                                      void *buf, uint16_t len, uint16_t offset)
+{
+	hal_battery_forecast_t forecast;
+	int err = hal_battery_get_forecast(&forecast);
+	
+	if (err == HAL_BATTERY_ERROR_NO_DATA) {
+		LOG_DBG("Previsão ainda sem amostras suficientes (%u)", forecast.samples);
+	} else if (err) {
+		LOG_ERR("Erro ao ler previsão da bateria (err %d)", err);
+		return BT_GATT_ERR(BT_ATT_ERR_UNLIKELY);
+	}
+	
+	struct battery_forecast_pdu pdu = {
+		.days_remaining = sys_cpu_to_le16(forecast.days_remaining),
+		.slope_uv_per_day = sys_cpu_to_le32(forecast.slope_uv_per_day),
+		.fitted_mv = sys_cpu_to_le16(forecast.fitted_mv),
+		.critical_mv = sys_cpu_to_le16(forecast.critical_mv),
+		.samples = sys_cpu_to_le16(forecast.samples),
+	};
+	
+	return bt_gatt_attr_read(conn, attr, buf, len, offset,
+	                         &pdu, sizeof(pdu));
+}
+
+/*******************************************************************************
+ * DOWNLOAD DO HISTÓRICO
+ ******************************************************************************/
+
+/**
+ * @brief Inicia o download pedido por START (work item)
+ */
+static void history_dump_begin(void)
+{
+	history_dump.conn = history_dump.req_conn;
+	history_dump.req_conn = NULL;
+	
+	// Nova geração: callbacks de envio de um download anterior não
+	// mexem mais no contador de notificações em trânsito
+	atomic_inc(&history_dump.gen);
+	atomic_set(&history_dump.inflight, 0);
+	
+	hal_battery_history_get_info(&history_dump.info);
+	history_dump.next_seq = history_dump.info.first_seq;
+	history_dump.chunk = 0;
+	history_dump.status = HISTORY_STATUS_OK;
+	history_dump.stage = DUMP_HEADER;
+	
+	LOG_INF("Download do histórico iniciado: %u amostras", history_dump.info.count);
+	
+	// Rajada de notificações: pede o PHY 2M para encurtar o rádio ligado
+	hal_ble_set_bulk_transfer(true);
+}
+
+/**
+ * @brief Encerra o download e libera a conexão (work item)
+ */
+static void history_dump_finish(void)
+{
+	history_dump.stage = DUMP_IDLE;
+	
+	// Notificações ainda em trânsito são da geração encerrada
+	atomic_inc(&history_dump.gen);
+	atomic_set(&history_dump.inflight, 0);
+	
+	if (history_dump.conn) {
+		bt_conn_unref(history_dump.conn);
+		history_dump.conn = NULL;
+		
+		// Fim da rajada: a conexão pode deixar o PHY 2M
+		hal_ble_set_bulk_transfer(false);
+	}
+	
+	atomic_clear_bit(&history_dump.flags, DUMP_FLAG_ABORT);
+	atomic_clear_bit(&history_dump.flags, DUMP_FLAG_BUSY);
+}
+
+/**
+ * @brief Verifica se a conexão do download continua ativa
+ */
+static bool history_dump_conn_alive(void)
+{
+	struct bt_conn_info info;
+	
+	return bt_conn_get_info(history_dump.conn, &info) == 0 &&
+	       info.state == BT_CONN_STATE_CONNECTED;
+}
+
+/**
+ * @brief Monta o próximo pacote do download
+ * 
+ * @param pkt Buffer de destino
+ * @param max_len Payload máximo permitido pelo MTU
+ * @param samples Número de amostras contidas no pacote
+ * @return Tamanho do pacote
+ */
+static uint16_t history_build_packet(uint8_t *pkt, uint16_t max_len, size_t *samples)
+{
+	*samples = 0;
+	
+	if (history_dump.stage == DUMP_DATA) {
+		uint32_t end_seq = history_dump.info.first_seq + history_dump.info.count;
+		size_t room = MIN((size_t)(max_len - HISTORY_PKT_DATA_HDR_LEN),
+		                  (size_t)(end_seq - history_dump.next_seq));
+		
+		int n = hal_battery_history_read(history_dump.next_seq,
+		                                 (int8_t *)&pkt[HISTORY_PKT_DATA_HDR_LEN],
+		                                 room);
+		if (n > 0) {
+			// O cabeçalho anuncia o valor absoluto da primeira amostra:
+			// o delta dela é 0 (apenas no trecho que começa em first_seq)
+			if (history_dump.next_seq == history_dump.info.first_seq) {
+				pkt[HISTORY_PKT_DATA_HDR_LEN] = 0;
+			}
+			
+			pkt[0] = HISTORY_PKT_DATA;
+			sys_put_le16(history_dump.chunk, &pkt[1]);
+			*samples = n;
+			return HISTORY_PKT_DATA_HDR_LEN + n;
+		}
+		
+		// Trecho sobrescrito durante o download: encerra com erro
+		LOG_WRN("Histórico sobrescrito durante o download");
+		history_dump.status = HISTORY_STATUS_OVERWRITTEN;
+		history_dump.stage = DUMP_END;
+	}
+	
+	if (history_dump.stage == DUMP_HEADER) {
+		struct battery_history_header_pdu *hdr = (void *)pkt;
+		
+		hdr->type = HISTORY_PKT_HEADER;
+		hdr->version = HISTORY_FORMAT_VERSION;
+		hdr->interval_s = sys_cpu_to_le16(history_dump.info.interval_s);
+		hdr->resolution_mv = history_dump.info.resolution_mv;
+		hdr->first_seq = sys_cpu_to_le32(history_dump.info.first_seq);
+		hdr->count = sys_cpu_to_le16(history_dump.info.count);
+		hdr->first_mv = sys_cpu_to_le16(history_dump.info.first_mv);
+		
+		return sizeof(*hdr);
+	}
+	
+	pkt[0] = HISTORY_PKT_END;
+	pkt[1] = history_dump.status;
+	
+	return 2;
+}
+
+/**
+ * @brief Avança o download após um pacote ser aceito pelo stack
+ */
+static void history_advance(size_t samples)
+{
+	uint32_t end_seq = history_dump.info.first_seq + history_dump.info.count;
+	
+	switch (history_dump.stage) {
+	case DUMP_HEADER:
+		history_dump.stage = (history_dump.info.count > 0) ? DUMP_DATA : DUMP_END;
+		break;
+	case DUMP_DATA:
+		history_dump.next_seq += samples;
+		history_dump.chunk++;
+		if (history_dump.next_seq >= end_seq) {
+			history_dump.stage = DUMP_END;
+		}
+		break;
+	case DUMP_END:
+	default:
+		LOG_INF("Download do histórico concluído (status %d)", history_dump.status);
+		history_dump_finish();
+		break;
+	}
+}
+
+/**
+ * @brief Escrita na característica Battery History (controle do download)
+ */
+static ssize_t write_battery_history(struct bt_conn *conn,
+                                      const struct bt_gatt_attr *attr,
+                                      const void *buf, uint16_t len,
+                                      uint16_t offset, uint8_t flags)
+{
+	if (len != 1U || offset != 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+	
+	uint8_t cmd = *((const uint8_t *)buf);
+	
+	if (cmd == HISTORY_CMD_ABORT) {
+		// O work item encerra com o pacote END (ABORTED)
+		if (atomic_test_bit(&history_dump.flags, DUMP_FLAG_BUSY)) {
+			atomic_set_bit(&history_dump.flags, DUMP_FLAG_ABORT);
+			k_work_reschedule(&history_dump_work, K_NO_WAIT);
+		}
+		return len;
+	}
+	
+	if (cmd != HISTORY_CMD_START) {
+		return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+	}
+	
+	// A conexão que solicita precisa estar inscrita (não basta outra)
+	if (!history_notify_enabled ||
+	    !bt_gatt_is_subscribed(conn, attr, BT_GATT_CCC_NOTIFY)) {
+		return BT_GATT_ERR(BT_ATT_ERR_CCC_IMPROPER_CONF);
+	}
+	
+	if (atomic_test_and_set_bit(&history_dump.flags, DUMP_FLAG_BUSY)) {
+		return BT_GATT_ERR(BT_ATT_ERR_PROCEDURE_IN_PROGRESS);
+	}
+	
+	// Reservado: o work item assume a referência e inicia o download
+	history_dump.req_conn = bt_conn_ref(conn);
+	atomic_set_bit(&history_dump.flags, DUMP_FLAG_START);
+	
+	k_work_reschedule(&history_dump_work, K_NO_WAIT);
+	
+	return len;
+}
+
 /*******************************************************************************
  * FUNÇÕES DE CCC (Client Characteristic Configuration)
  ******************************************************************************/
@@ -156,10 +602,40 @@ static void battery_level_ccc_changed(const struct bt_gatt_attr *attr,
 {
 	notify_enabled = (value == BT_GATT_CCC_NOTIFY);
 	
+	// Força o envio do valor atual na próxima amostragem
+	last_notified_level = LEVEL_NOT_NOTIFIED;
+	
 	LOG_INF("Notificações de bateria %s",
 	        notify_enabled ? "HABILITADAS" : "DESABILITADAS");
 }
 
+/**
+ * @brief Callback quando cliente habilita/desabilita notificações de status
+ */
+static void battery_status_ccc_changed(const struct bt_gatt_attr *attr,
+                                        uint16_t value)
+{
+	status_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+	
+	// Força o envio do valor atual na próxima amostragem
+	last_notified_level = LEVEL_NOT_NOTIFIED;
+	
+	LOG_INF("Notificações de status da bateria %s",
+	        status_notify_enabled ? "HABILITADAS" : "DESABILITADAS");
+}
+
+/**
+ * @brief Callback quando cliente habilita/desabilita notificações do histórico
+ */
+static void battery_history_ccc_changed(const struct bt_gatt_attr *attr,
+                                         uint16_t value)
+{
+	history_notify_enabled = (value == BT_GATT_CCC_NOTIFY);
+	
+	LOG_INF("Notificações do histórico da bateria %s",
+	        history_notify_enabled ? "HABILITADAS" : "DESABILITADAS");
+}
+
 /*******************************************************************************
  * DEFINIÇÃO DO SERVIÇO GATT
  ******************************************************************************/
@@ -193,6 +669,35 @@ BT_GATT_SERVICE_DEFINE(battery_svc,
 	                       BT_GATT_CHRC_READ,
 	                       BT_GATT_PERM_READ,
 	                       read_battery_state, NULL, NULL),
+	
+	// Characteristic: Battery Status (customizado)
+	// Propriedades: Read + Notify
+	BT_GATT_CHARACTERISTIC(BT_UUID_BATTERY_STATUS,
+	                       BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+	                       BT_GATT_PERM_READ,
+	                       read_battery_status, NULL, NULL),
+	
+	// CCC Descriptor para notificações de status
+	BT_GATT_CCC(battery_status_ccc_changed,
+	            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+	
+	// Characteristic: Battery History (customizado)
+	// Propriedades: Write (controle do download) + Notify (dados)
+	BT_GATT_CHARACTERISTIC(BT_UUID_BATTERY_HISTORY,
+	                       BT_GATT_CHRC_WRITE | BT_GATT_CHRC_NOTIFY,
+	                       BT_GATT_PERM_WRITE,
+	                       NULL, write_battery_history, NULL),
+	
+	// CCC Descriptor para notificações do histórico
+	BT_GATT_CCC(battery_history_ccc_changed,
+	            BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+	
+	// Characteristic: Battery Forecast (customizado)
+	// Propriedades: Read
+	BT_GATT_CHARACTERISTIC(BT_UUID_BATTERY_FORECAST,
+	                       BT_GATT_CHRC_READ,
+	                       BT_GATT_PERM_READ,
+	                       read_battery_forecast, NULL, NULL),
 );
 
 /*******************************************************************************
@@ -200,44 +705,246 @@ BT_GATT_SERVICE_DEFINE(battery_svc,
  ******************************************************************************/
 
 /**
- * @brief Callback de conexão BLE
+ * @brief Callback de desconexão BLE
+ * 
+ * As flags de notificação não são zeradas aqui: o stack recalcula o
+ * valor agregado de cada CCC sem a conexão encerrada e chama os
+ * callbacks de CCC se ele mudar.
+ */
+static void disconnected_cb(struct bt_conn *conn, uint8_t reason)
+{
+	LOG_DBG("Cliente BLE desconectado (razão %u)", reason);
+	
+	// O work item confere se a conexão do download caiu e o encerra
+	if (atomic_test_bit(&history_dump.flags, DUMP_FLAG_BUSY)) {
+		k_work_reschedule(&history_dump_work, K_NO_WAIT);
+	}
+}
+
+// Estrutura de callbacks de conexão
+BT_CONN_CB_DEFINE(battery_conn_callbacks) = {
+	.disconnected = disconnected_cb,
+};
+
+/*******************************************************************************
+ * MOTOR DE NOTIFICAÇÃO
+ ******************************************************************************/
+
+/**
+ * @brief Verifica se o valor atual justifica uma notificação
+ * 
+ * @return true se o percentual saiu da banda de histerese em torno do
+ *         último valor notificado ou se o estado mudou
+ */
+static bool battery_change_is_significant(void)
+{
+	if (last_notified_level == LEVEL_NOT_NOTIFIED) {
+		return true;
+	}
+	
+	if (battery_state != last_notified_state) {
+		return true;
+	}
+	
+	int delta = (int)battery_level - (int)last_notified_level;
+	
+	return (delta >= CONFIG_GATT_BATTERY_NOTIFY_DELTA_PCT ||
+	        delta <= -CONFIG_GATT_BATTERY_NOTIFY_DELTA_PCT);
+}
+
+/**
+ * @brief Notifica a característica Battery Status
  */
-static void connected_cb(struct bt_conn *conn, uint8_t err)
+static void notify_battery_status(void)
 {
+	struct battery_status_pdu pdu;
+	
+	if (build_status_pdu(&pdu) != 0) {
+		return;
+	}
+	
+	// NULL: uma notificação para todas as conexões inscritas
+	int err = bt_gatt_notify(NULL,
+	                         &battery_svc.attrs[BATTERY_STATUS_ATTR_IDX],
+	                         &pdu, sizeof(pdu));
 	if (err) {
-		LOG_ERR("Falha na conexão (err %u)", err);
+		LOG_ERR("Falha ao notificar status da bateria (err %d)", err);
+	}
+}
+
+/**
+ * @brief Envia as notificações habilitadas com os valores atuais
+ */
+static void notify_send(void)
+{
+	if (status_notify_enabled) {
+		notify_battery_status();
+	}
+	
+	if (notify_enabled) {
+		gatt_battery_service_notify(battery_level);
+	} else {
+		last_notified_level = battery_level;
+		last_notified_state = battery_state;
+		last_notify_ms = k_uptime_get();
+	}
+}
+
+/**
+ * @brief Envia a notificação se a mudança ainda for significativa
+ */
+static void notify_if_significant(void)
+{
+	if ((!notify_enabled && !status_notify_enabled) ||
+	    !battery_change_is_significant()) {
 		return;
 	}
 	
-	// Armazena conexão para notificações
-	if (current_conn) {
-		bt_conn_unref(current_conn);
+	int64_t elapsed_ms = k_uptime_get() - last_notify_ms;
+	
+	if (elapsed_ms < CONFIG_GATT_BATTERY_NOTIFY_MIN_INTERVAL_MS) {
+		// Coalesce: envia o valor mais recente ao fim da janela
+		k_work_schedule(&notify_work,
+		                K_MSEC(CONFIG_GATT_BATTERY_NOTIFY_MIN_INTERVAL_MS - elapsed_ms));
+		return;
 	}
-	current_conn = bt_conn_ref(conn);
 	
-	LOG_DBG("Cliente BLE conectado");
+	notify_send();
 }
 
 /**
- * @brief Callback de desconexão BLE
+ * @brief Handler do envio coalescido
  */
-static void disconnected_cb(struct bt_conn *conn, uint8_t reason)
+static void notify_work_handler(struct k_work *work)
 {
-	LOG_DBG("Cliente BLE desconectado (razão %u)", reason);
+	notify_if_significant();
+}
+
+/**
+ * @brief Callback de amostragem periódica do HAL Battery
+ * 
+ * Executa na work queue do sistema.
+ */
+static void on_battery_sample(const hal_battery_info_t *info)
+{
+	battery_level = info->percentage;
+	battery_voltage = info->voltage_mv;
+	battery_state = (uint8_t)info->state;
+	
+	notify_if_significant();
+}
+
+/**
+ * @brief Callback do evento de bateria crítica do HAL Battery
+ * 
+ * Executa na work queue do sistema. Notifica imediatamente, ignorando o
+ * intervalo mínimo entre notificações.
+ */
+static void on_battery_critical(void)
+{
+	hal_battery_info_t info;
 	
-	if (current_conn) {
-		bt_conn_unref(current_conn);
-		current_conn = NULL;
+	if (get_battery_snapshot(&info) == HAL_BATTERY_SUCCESS) {
+		battery_level = info.percentage;
+		battery_voltage = info.voltage_mv;
 	}
 	
-	notify_enabled = false;
+	battery_state = HAL_BATTERY_STATE_CRITICAL;
+	
+	LOG_WRN("Bateria crítica: notificando imediatamente");
+	
+	k_work_cancel_delayable(&notify_work);
+	
+	if (notify_enabled || status_notify_enabled) {
+		notify_send();
+	}
 }
 
-// Estrutura de callbacks de conexão
-BT_CONN_CB_DEFINE(battery_conn_callbacks) = {
-	.connected = connected_cb,
-	.disconnected = disconnected_cb,
-};
+/*******************************************************************************
+ * ENVIO DO HISTÓRICO
+ ******************************************************************************/
+
+/**
+ * @brief Callback de envio concluído de uma notificação do histórico
+ */
+static void history_dump_sent(struct bt_conn *conn, void *user_data)
+{
+	// Envio de um download já encerrado
+	if ((atomic_val_t)POINTER_TO_UINT(user_data) != atomic_get(&history_dump.gen)) {
+		return;
+	}
+	
+	atomic_dec(&history_dump.inflight);
+	k_work_reschedule(&history_dump_work, K_NO_WAIT);
+}
+
+/**
+ * @brief Handler do download: mantém até HISTORY_DUMP_WINDOW notificações
+ *        em trânsito, retomando a cada envio concluído
+ * 
+ * Único contexto que altera o estado do download: aplica os pedidos de
+ * START e ABORT e encerra o download se a conexão caiu (o stack descarta
+ * os callbacks de envio pendentes na desconexão).
+ */
+static void history_dump_work_handler(struct k_work *work)
+{
+	if (atomic_test_and_clear_bit(&history_dump.flags, DUMP_FLAG_START)) {
+		history_dump_begin();
+	}
+	
+	if (history_dump.stage == DUMP_IDLE) {
+		return;
+	}
+	
+	if (!history_dump_conn_alive()) {
+		LOG_INF("Download do histórico interrompido pela desconexão");
+		history_dump_finish();
+		return;
+	}
+	
+	if (atomic_test_and_clear_bit(&history_dump.flags, DUMP_FLAG_ABORT) &&
+	    history_dump.stage != DUMP_END) {
+		history_dump.status = HISTORY_STATUS_ABORTED;
+		history_dump.stage = DUMP_END;
+	}
+	
+	while (history_dump.stage != DUMP_IDLE &&
+	       atomic_get(&history_dump.inflight) < HISTORY_DUMP_WINDOW) {
+		uint8_t pkt[HISTORY_PKT_MAX];
+		uint16_t max_len = MIN(bt_gatt_get_mtu(history_dump.conn) - 3, sizeof(pkt));
+		size_t samples;
+		uint16_t len = history_build_packet(pkt, max_len, &samples);
+		
+		struct bt_gatt_notify_params params = {
+			.attr = &battery_svc.attrs[BATTERY_HISTORY_ATTR_IDX],
+			.data = pkt,
+			.len = len,
+			.func = history_dump_sent,
+			.user_data = UINT_TO_POINTER(atomic_get(&history_dump.gen)),
+		};
+		
+		atomic_inc(&history_dump.inflight);
+		
+		int err = bt_gatt_notify_cb(history_dump.conn, &params);
+		if (err == -ENOMEM) {
+			// Sem buffers: retoma no próximo envio concluído
+			atomic_dec(&history_dump.inflight);
+			if (atomic_get(&history_dump.inflight) == 0) {
+				k_work_schedule(&history_dump_work, K_MSEC(HISTORY_DUMP_RETRY_MS));
+			}
+			return;
+		}
+		
+		if (err) {
+			atomic_dec(&history_dump.inflight);
+			LOG_ERR("Falha ao enviar histórico (err %d)", err);
+			history_dump_finish();
+			return;
+		}
+		
+		history_advance(samples);
+	}
+}
 
 /*******************************************************************************
  * API PÚBLICA
@@ -247,9 +954,12 @@ int gatt_battery_service_init(const struct gatt_battery_service_cb *callbacks)
 {
 	app_callbacks = callbacks;
 	
-	// Lê valor inicial da bateria
+	k_work_init_delayable(&notify_work, notify_work_handler);
+	k_work_init_delayable(&history_dump_work, history_dump_work_handler);
+	
+	// Lê valor inicial da bateria (snapshot feito em hal_battery_init)
 	hal_battery_info_t info;
-	int err = hal_battery_get_info(&info);
+	int err = get_battery_snapshot(&info);
 	
 	if (err == HAL_BATTERY_SUCCESS) {
 		battery_level = info.percentage;
@@ -264,24 +974,34 @@ int gatt_battery_service_init(const struct gatt_battery_service_cb *callbacks)
 		LOG_WRN("Battery Service inicializado, mas leitura inicial falhou");
 	}
 	
+	// Notificações orientadas pelas amostragens periódicas do HAL
+	err = hal_battery_register_sample_cb(on_battery_sample);
+	if (err != HAL_BATTERY_SUCCESS) {
+		LOG_ERR("Falha ao registrar callback de amostragem (err %d)", err);
+		return err;
+	}
+	
+	// Evento de bateria crítica (comparador POF)
+	err = hal_battery_register_critical_cb(on_battery_critical);
+	if (err != HAL_BATTERY_SUCCESS) {
+		LOG_ERR("Falha ao registrar callback de bateria crítica (err %d)", err);
+		return err;
+	}
+	
 	return 0;
 }
 
 int gatt_battery_service_notify(uint8_t percentage)
 {
-	if (!current_conn) {
-		LOG_DBG("Nenhum cliente conectado para notificar");
-		return -ENOTCONN;
-	}
-	
 	if (!notify_enabled) {
-		LOG_DBG("Notificações não habilitadas pelo cliente");
+		LOG_DBG("Nenhum cliente inscrito nas notificações");
 		return -EACCES;
 	}
 	
 	battery_level = percentage;
 	
-	int err = bt_gatt_notify(current_conn, &battery_svc.attrs[1],
+	// NULL: uma notificação para todas as conexões inscritas
+	int err = bt_gatt_notify(NULL, &battery_svc.attrs[BATTERY_LEVEL_ATTR_IDX],
 	                         &battery_level, sizeof(battery_level));
 	
 	if (err) {
@@ -289,6 +1009,10 @@ int gatt_battery_service_notify(uint8_t percentage)
 		return err;
 	}
 	
+	last_notified_level = percentage;
+	last_notified_state = battery_state;
+	last_notify_ms = k_uptime_get();
+	
 	LOG_DBG("Notificação de bateria enviada: %d%%", percentage);
 	
 	return 0;
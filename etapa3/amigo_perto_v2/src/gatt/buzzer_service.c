@@ -11,7 +11,7 @@
  * 
  * Componentes principais:
  * - Serviço GATT primário com UUID customizado (128-bit)
- * - Característica de escrita para buzzer intermitente (Write without response)
+ * - Característica de escrita para buzzer intermitente (Write e Write without response)
  * - Callbacks para comunicação com a aplicação principal
  * - Validação de dados recebidos (0x00=OFF, 0x01=ON)
  * 
@@ -114,7 +114,8 @@ static ssize_t write_buzzer_intermittent(struct bt_conn *conn, const struct bt_g
  * Estrutura:
  * - Serviço Primário: Buzzer Service (identificado por BT_UUID_BUZZER_SERVICE)
  *   - Característica Buzzer Intermitente: Permite escrita de 1 byte (0x00 ou 0x01)
- *     - Propriedade: WRITE (escrita sem resposta)
+ *     - Propriedades: WRITE e WRITE WITHOUT RESPONSE (o app usa a escrita
+ *       sem resposta, que dispara o alarme sem esperar o ATT Write Response)
  *     - Permissão: WRITE (qualquer dispositivo conectado pode escrever)
  *     - Callback de escrita: write_buzzer_intermittent()
  */
@@ -125,7 +126,8 @@ BT_GATT_SERVICE_DEFINE(buzzer_svc,
 	// Define a característica de Buzzer Intermitente
 	BT_GATT_CHARACTERISTIC(
 		BT_UUID_BUZZER_INTERMITTENT_CHAR,  // UUID da característica
-		BT_GATT_CHRC_WRITE,               // Propriedade: permite escrita
+		BT_GATT_CHRC_WRITE |
+		BT_GATT_CHRC_WRITE_WITHOUT_RESP,  // Propriedades: escrita com e sem resposta
 		BT_GATT_PERM_WRITE,               // Permissão: escrita permitida
 		NULL,                             // Callback de leitura (não usado)
 		write_buzzer_intermittent,        // Callback de escrita
@@ -0,0 +1,183 @@
+/*
+ * GATT Immediate Alert Service - Alarme disparado pelo central
+ *
+ * @file immediate_alert_service.c
+ * @brief Implementação do Immediate Alert Service (0x1802)
+ * Localização: src/gatt/immediate_alert_service.c
+ * Header público: include/gatt/immediate_alert_service.h
+ *
+ * Implementa o Immediate Alert Service padrão do Bluetooth (Proximity
+ * Profile). O aplicativo grava o nível na característica Alert Level com
+ * Write Without Response: o alarme é acionado assim que o pacote chega,
+ * sem a ida e volta do ATT Write Response.
+ *
+ * Características implementadas:
+ * - Alert Level (0x2A06) - Padrão Bluetooth SIG (Write Without Response)
+ *
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "gatt/immediate_alert_service.h"
+
+// Zephyr includes
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/conn.h>
+
+// Registra módulo de logging
+LOG_MODULE_REGISTER(gatt_immediate_alert, LOG_LEVEL_DBG);
+
+/*******************************************************************************
+ * VARIÁVEIS PRIVADAS
+ ******************************************************************************/
+
+// Callbacks da aplicação
+static const struct gatt_immediate_alert_service_cb *app_callbacks = NULL;
+
+// Nível do alerta imediato em andamento
+static atomic_t alert_level = ATOMIC_INIT(GATT_ALERT_LEVEL_NONE);
+
+// Conexão que gravou o nível em andamento (bt_conn_index())
+static atomic_t alert_owner;
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS
+ ******************************************************************************/
+
+/**
+ * @brief Repassa o nível de alerta à aplicação
+ */
+static void alert_notify(gatt_alert_level_t level)
+{
+	if (app_callbacks && app_callbacks->alert_cb) {
+		app_callbacks->alert_cb(level);
+	}
+}
+
+/**
+ * @brief Conta as outras conexões ativas (callback de bt_conn_foreach)
+ */
+static void count_connected(struct bt_conn *conn, void *data)
+{
+	struct bt_conn_info info;
+
+	if (bt_conn_get_info(conn, &info) == 0 && info.state == BT_CONN_STATE_CONNECTED) {
+		(*(uint8_t *)data)++;
+	}
+}
+
+/*******************************************************************************
+ * CALLBACKS GATT
+ ******************************************************************************/
+
+/**
+ * @brief Callback de escrita da característica Alert Level
+ *
+ * Chega por Write Without Response: o retorno de erro não é enviado ao
+ * central, apenas descarta a escrita inválida.
+ */
+static ssize_t write_alert_level(struct bt_conn *conn,
+                                 const struct bt_gatt_attr *attr,
+                                 const void *buf, uint16_t len,
+                                 uint16_t offset, uint8_t flags)
+{
+	if (offset != 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+	}
+
+	if (len != sizeof(uint8_t)) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+
+	uint8_t level = *((const uint8_t *)buf);
+
+	if (level > GATT_ALERT_LEVEL_HIGH) {
+		LOG_DBG("Nível de alerta imediato inválido: %u", level);
+		return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+	}
+
+	atomic_set(&alert_owner, bt_conn_index(conn));
+	atomic_set(&alert_level, level);
+
+	LOG_INF("Alerta imediato: nível %u", level);
+
+	alert_notify((gatt_alert_level_t)level);
+
+	return len;
+}
+
+/*******************************************************************************
+ * DEFINIÇÃO DO SERVIÇO GATT
+ ******************************************************************************/
+
+// Definição do Immediate Alert Service
+BT_GATT_SERVICE_DEFINE(immediate_alert_svc,
+	// Primary Service: Immediate Alert Service (0x1802)
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_IAS),
+
+	// Characteristic: Alert Level (0x2A06)
+	// Propriedades: Write Without Response (conforme a especificação)
+	BT_GATT_CHARACTERISTIC(BT_UUID_ALERT_LEVEL,
+	                       BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+	                       BT_GATT_PERM_WRITE,
+	                       NULL, write_alert_level, NULL),
+);
+
+/*******************************************************************************
+ * CALLBACKS DE CONEXÃO
+ ******************************************************************************/
+
+/**
+ * @brief Callback de desconexão BLE: encerra o alerta imediato
+ *
+ * Apenas a desconexão do central que gravou o nível em andamento encerra
+ * o alerta; a queda de outro celular não o afeta. Se era a última
+ * conexão, o buzzer fica a cargo do Link Loss Service.
+ */
+static void disconnected_cb(struct bt_conn *conn, uint8_t reason)
+{
+	if (atomic_get(&alert_owner) != bt_conn_index(conn)) {
+		return;
+	}
+
+	if (atomic_set(&alert_level, GATT_ALERT_LEVEL_NONE) == GATT_ALERT_LEVEL_NONE) {
+		return;
+	}
+
+	LOG_INF("Alerta imediato encerrado na desconexão");
+
+	uint8_t connected = 0;
+
+	bt_conn_foreach(BT_CONN_TYPE_LE, count_connected, &connected);
+
+	if (connected > 0) {
+		alert_notify(GATT_ALERT_LEVEL_NONE);
+	}
+}
+
+// Estrutura de callbacks de conexão
+BT_CONN_CB_DEFINE(immediate_alert_conn_callbacks) = {
+	.disconnected = disconnected_cb,
+};
+
+/*******************************************************************************
+ * API PÚBLICA
+ ******************************************************************************/
+
+int gatt_immediate_alert_service_init(const struct gatt_immediate_alert_service_cb *callbacks)
+{
+	app_callbacks = callbacks;
+
+	LOG_INF("Immediate Alert Service inicializado");
+
+	return 0;
+}
+
+gatt_alert_level_t gatt_immediate_alert_service_get_level(void)
+{
+	return (gatt_alert_level_t)atomic_get(&alert_level);
+}
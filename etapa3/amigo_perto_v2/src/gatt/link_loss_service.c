@@ -0,0 +1,235 @@
+/*
+ * GATT Link Loss Service - Alerta local na perda do enlace BLE
+ * 
+ * @file link_loss_service.c
+ * @brief Implementação do Link Loss Service (0x1803)
+ * Localização: src/gatt/link_loss_service.c
+ * Header público: include/gatt/link_loss_service.h
+ * 
+ * Implementa o Link Loss Service padrão do Bluetooth (Proximity Profile).
+ * O nível gravado pelo central na característica Alert Level é aplicado
+ * quando a conexão cai por timeout de supervisão (ou de resposta do link
+ * layer), isto é, quando o cão sai do alcance sem que ninguém tenha
+ * encerrado a conexão. A coleira percebe a perda pelo próprio timeout de
+ * supervisão, sem esperar o celular.
+ * 
+ * Com vários celulares conectados, só a perda da última conexão dispara
+ * o alerta: enquanto algum celular estiver conectado, o cão está ao
+ * alcance de alguém da família.
+ * 
+ * Características implementadas:
+ * - Alert Level (0x2A06) - Padrão Bluetooth SIG (Read + Write)
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "gatt/link_loss_service.h"
+
+// Zephyr includes
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/hci.h>
+
+// Registra módulo de logging
+LOG_MODULE_REGISTER(gatt_link_loss, LOG_LEVEL_DBG);
+
+/*******************************************************************************
+ * VARIÁVEIS PRIVADAS
+ ******************************************************************************/
+
+// Callbacks da aplicação
+static const struct gatt_link_loss_service_cb *app_callbacks = NULL;
+
+// Nível configurado pelo central (mantido entre conexões)
+static uint8_t alert_level = CONFIG_GATT_LINK_LOSS_DEFAULT_LEVEL;
+
+// Alerta de perda de enlace em andamento
+static atomic_t alerting = ATOMIC_INIT(0);
+
+// Conexões ativas
+static atomic_t conn_count = ATOMIC_INIT(0);
+
+// Encerra o alerta após CONFIG_GATT_LINK_LOSS_ALERT_TIMEOUT_S
+static struct k_work_delayable alert_timeout_work;
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS
+ ******************************************************************************/
+
+/**
+ * @brief Repassa o nível de alerta à aplicação
+ */
+static void alert_notify(gatt_alert_level_t level)
+{
+	if (app_callbacks && app_callbacks->alert_cb) {
+		app_callbacks->alert_cb(level);
+	}
+}
+
+/**
+ * @brief Verifica se o motivo da desconexão caracteriza perda de enlace
+ */
+static bool reason_is_link_loss(uint8_t reason)
+{
+	return reason == BT_HCI_ERR_CONN_TIMEOUT ||
+	       reason == BT_HCI_ERR_LL_RESP_TIMEOUT;
+}
+
+/**
+ * @brief Handler do fim do tempo de alerta
+ */
+static void alert_timeout_work_handler(struct k_work *work)
+{
+	if (atomic_cas(&alerting, 1, 0)) {
+		LOG_INF("Tempo de alerta de perda de enlace esgotado");
+		alert_notify(GATT_ALERT_LEVEL_NONE);
+	}
+}
+
+/*******************************************************************************
+ * CALLBACKS GATT
+ ******************************************************************************/
+
+/**
+ * @brief Callback de leitura da característica Alert Level
+ */
+static ssize_t read_alert_level(struct bt_conn *conn,
+                                const struct bt_gatt_attr *attr,
+                                void *buf, uint16_t len, uint16_t offset)
+{
+	return bt_gatt_attr_read(conn, attr, buf, len, offset,
+	                         &alert_level, sizeof(alert_level));
+}
+
+/**
+ * @brief Callback de escrita da característica Alert Level
+ */
+static ssize_t write_alert_level(struct bt_conn *conn,
+                                 const struct bt_gatt_attr *attr,
+                                 const void *buf, uint16_t len,
+                                 uint16_t offset, uint8_t flags)
+{
+	if (offset != 0) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_OFFSET);
+	}
+	
+	if (len != sizeof(alert_level)) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+	
+	uint8_t level = *((const uint8_t *)buf);
+	
+	if (level > GATT_ALERT_LEVEL_HIGH) {
+		return BT_GATT_ERR(BT_ATT_ERR_VALUE_NOT_ALLOWED);
+	}
+	
+	alert_level = level;
+	
+	LOG_INF("Nível de alerta de perda de enlace: %u", alert_level);
+	
+	return len;
+}
+
+/*******************************************************************************
+ * DEFINIÇÃO DO SERVIÇO GATT
+ ******************************************************************************/
+
+// Definição do Link Loss Service
+BT_GATT_SERVICE_DEFINE(link_loss_svc,
+	// Primary Service: Link Loss Service (0x1803)
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_LLS),
+	
+	// Characteristic: Alert Level (0x2A06)
+	// Propriedades: Read + Write (com resposta, conforme a especificação)
+	BT_GATT_CHARACTERISTIC(BT_UUID_ALERT_LEVEL,
+	                       BT_GATT_CHRC_READ | BT_GATT_CHRC_WRITE,
+	                       BT_GATT_PERM_READ | BT_GATT_PERM_WRITE,
+	                       read_alert_level, write_alert_level, NULL),
+);
+
+/*******************************************************************************
+ * CALLBACKS DE CONEXÃO
+ ******************************************************************************/
+
+/**
+ * @brief Callback de conexão BLE: a reconexão encerra o alerta
+ */
+static void connected_cb(struct bt_conn *conn, uint8_t err)
+{
+	if (err) {
+		return;
+	}
+	
+	atomic_inc(&conn_count);
+	
+	if (atomic_cas(&alerting, 1, 0)) {
+		k_work_cancel_delayable(&alert_timeout_work);
+		
+		LOG_INF("Enlace restabelecido, alerta encerrado");
+		alert_notify(GATT_ALERT_LEVEL_NONE);
+	}
+}
+
+/**
+ * @brief Callback de desconexão BLE
+ */
+static void disconnected_cb(struct bt_conn *conn, uint8_t reason)
+{
+	// Ainda há celulares conectados: nem alerta nem silencia o buzzer
+	if (atomic_dec(&conn_count) > 1) {
+		LOG_INF("Conexão encerrada (motivo 0x%02x), outras seguem ativas", reason);
+		return;
+	}
+	
+	if (!reason_is_link_loss(reason) || alert_level == GATT_ALERT_LEVEL_NONE) {
+		// Desconexão solicitada: não deixa alarme tocando
+		alert_notify(GATT_ALERT_LEVEL_NONE);
+		return;
+	}
+	
+	LOG_WRN("Perda de enlace (motivo 0x%02x), alerta nível %u", reason, alert_level);
+	
+	atomic_set(&alerting, 1);
+	alert_notify((gatt_alert_level_t)alert_level);
+	
+	if (CONFIG_GATT_LINK_LOSS_ALERT_TIMEOUT_S > 0) {
+		k_work_reschedule(&alert_timeout_work,
+		                  K_SECONDS(CONFIG_GATT_LINK_LOSS_ALERT_TIMEOUT_S));
+	}
+}
+
+// Estrutura de callbacks de conexão
+BT_CONN_CB_DEFINE(link_loss_conn_callbacks) = {
+	.connected = connected_cb,
+	.disconnected = disconnected_cb,
+};
+
+/*******************************************************************************
+ * API PÚBLICA
+ ******************************************************************************/
+
+int gatt_link_loss_service_init(const struct gatt_link_loss_service_cb *callbacks)
+{
+	app_callbacks = callbacks;
+	
+	k_work_init_delayable(&alert_timeout_work, alert_timeout_work_handler);
+	
+	LOG_INF("Link Loss Service inicializado - Nível: %u", alert_level);
+	
+	return 0;
+}
+
+gatt_alert_level_t gatt_link_loss_service_get_level(void)
+{
+	return (gatt_alert_level_t)alert_level;
+}
+
+bool gatt_link_loss_service_is_alerting(void)
+{
+	return atomic_get(&alerting) != 0;
+}
@@ -10,11 +10,23 @@
  * leitura de tensão e gerenciamento de estados de carga.
  * 
  * Características:
- * - Leitura via ADC com oversampling para maior precisão
- * - Otimizado para bateria tipo moeda CR2032 (3.0V nominal, 2.0V mínimo)
+ * - Leitura via ADC com oversampling para maior precisão (em hardware,
+ *   via SAADC burst, ou por média em software - selecionável via Kconfig)
+ * - Modo de aquisição por hardware (RTC + PPI + EasyDMA), sem acordar a
+ *   CPU a cada conversão (src/hal/battery_ppi.c)
+ * - Curva de descarga e divisor resistivo definidos no devicetree
+ *   (compatible "amigo,battery"); padrão CR2032 (3.0V nominal, 2.0V mínimo)
  * - Baixo consumo: ADC ativado apenas durante leitura
- * - Suporte a divider resistivo para leitura de tensão
- * - Interpolação linear por segmentos para cálculo de percentual
+ * - Amostragem periódica em segundo plano com snapshot em cache
+ * - Suporte a divider resistivo para leitura de tensão (ponto fixo)
+ * - Interpolação linear inteira por segmentos, com busca binária na curva
+ * - Medição sob carga: a queda de tensão sob carga (PWM do buzzer) é
+ *   registrada e usada no cálculo de percentual e estado
+ * - Compensação de temperatura pela temperatura do die (API de sensores)
+ *   e calibração de offset do SAADC apenas quando a temperatura varia
+ * - Aviso de bateria crítica orientado a evento pelo comparador POF
+ * - Leitura assíncrona (adc_read_async + k_work_poll): pedidos feitos
+ *   durante uma conversão compartilham o mesmo resultado
  * 
  * Copyright (c) 2025
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
@@ -28,6 +40,19 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/device.h>
 
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+#include <zephyr/drivers/sensor.h>
+#include <stdlib.h>
+#endif
+
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING)
+#include <nrfx_power.h>
+#endif
+
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+#include "battery_ppi.h"
+#endif
+
 // Registra módulo de logging
 LOG_MODULE_REGISTER(hal_battery, LOG_LEVEL_DBG);
 
@@ -45,6 +70,7 @@ LOG_MODULE_REGISTER(hal_battery, LOG_LEVEL_DBG);
 #else
 #define ADC_NODE DT_IO_CHANNELS_CTLR(DT_PATH(zephyr_user))
 #define ADC_CHANNEL DT_IO_CHANNELS_INPUT(DT_PATH(zephyr_user))
+#define ADC_CHANNEL_NODE DT_CHILD_BY_UNIT_ADDR_INT(ADC_NODE, ADC_CHANNEL)
 #define ADC_RESOLUTION 12
 #endif
 
@@ -55,28 +81,94 @@ LOG_MODULE_REGISTER(hal_battery, LOG_LEVEL_DBG);
 #define ADC_ACQUISITION_TIME ADC_ACQ_TIME(ADC_ACQ_TIME_MICROSECONDS, 10)
 
 // Número de leituras para média
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_HW_OVERSAMPLING)
+// Oversampling em hardware: 2^N amostras acumuladas pelo SAADC (modo burst)
+// e entregues em uma única conversão, sem intervalo entre amostras.
+// A propriedade zephyr,oversampling do canal no devicetree tem precedência.
+#if defined(ADC_CHANNEL_NODE)
+#define ADC_OVERSAMPLING    DT_PROP_OR(ADC_CHANNEL_NODE, zephyr_oversampling, \
+                                       CONFIG_HAL_BATTERY_OVERSAMPLING)
+#else
+#define ADC_OVERSAMPLING    CONFIG_HAL_BATTERY_OVERSAMPLING
+#endif
+#define ADC_SAMPLES         1
+#elif defined(CONFIG_HAL_BATTERY_SAMPLING_SOFTWARE)
+// Média por software: o driver realiza as conversões extras da sequence,
+// espaçadas de ADC_SAMPLE_INTERVAL_US
+#define ADC_OVERSAMPLING    0
 #define ADC_SAMPLES         4
+#define ADC_SAMPLE_INTERVAL_US 1000
+#endif
+
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+// Aquisição por hardware: o intervalo de CONFIG_HAL_BATTERY_SAMPLE_INTERVAL_MS
+// passa a ser o intervalo entre despertares (um buffer completo)
+#define PPI_SAMPLE_PERIOD_MS \
+	(CONFIG_HAL_BATTERY_SAMPLE_INTERVAL_MS / CONFIG_HAL_BATTERY_PPI_BUFFER_SAMPLES)
+
+// Limite inferior do SAADC: tensão do estado crítico
+#define PPI_CRITICAL_PCT    10
+#endif
 
-// Características da bateria CR2032
-#define BATTERY_VOLTAGE_MAX_MV   3000   /**< 3.0V - tensão máxima (100%) */
-#define BATTERY_VOLTAGE_GOOD_MV  2800   /**< 2.8V - bom (70%) */
-#define BATTERY_VOLTAGE_LOW_MV   2500   /**< 2.5V - baixo (30%) */
-#define BATTERY_VOLTAGE_CRIT_MV  2200   /**< 2.2V - crítico (10%) */
-#define BATTERY_VOLTAGE_MIN_MV   2000   /**< 2.0V - mínimo (0%) */
+// Características da bateria a partir do devicetree (compatible "amigo,battery")
+// A curva de descarga e o divisor resistivo variam com a química da bateria
+// (CR2032, Li-Po, AAA...), sem alterar o firmware.
+#if DT_HAS_COMPAT_STATUS_OKAY(amigo_battery)
+#define BATTERY_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(amigo_battery)
 
-// Divisor resistivo (se aplicável)
-// Se houver divisor resistivo R1/(R1+R2), ajustar:
-// Exemplo: R1=1M, R2=1M -> DIVIDER_RATIO = 2.0
-#define BATTERY_DIVIDER_RATIO    1.0f   /**< Razão do divisor (1.0 = sem divisor) */
+static const uint16_t curve_mv[] = DT_PROP(BATTERY_NODE, curve_millivolt);
+static const uint8_t curve_pct[] = DT_PROP(BATTERY_NODE, curve_percent);
+
+#define BATTERY_FULL_OHMS        DT_PROP_OR(BATTERY_NODE, full_ohms, 1)
+#define BATTERY_OUTPUT_OHMS      DT_PROP_OR(BATTERY_NODE, output_ohms, 1)
+#else
+// Padrão: bateria CR2032 sem divisor resistivo
+static const uint16_t curve_mv[] = { 3000, 2800, 2500, 2200, 2000 };
+static const uint8_t curve_pct[] = {  100,   70,   30,   10,    0 };
+
+#define BATTERY_FULL_OHMS        1
+#define BATTERY_OUTPUT_OHMS      1
+#endif
+
+#define CURVE_POINTS             ARRAY_SIZE(curve_mv)
+
+BUILD_ASSERT(ARRAY_SIZE(curve_mv) == ARRAY_SIZE(curve_pct),
+             "curve-millivolt e curve-percent devem ter o mesmo tamanho");
+BUILD_ASSERT(ARRAY_SIZE(curve_mv) >= 2,
+             "A curva de descarga precisa de ao menos 2 pontos");
+
+// Razão do divisor resistivo em ponto fixo Q10 (1024 = sem divisor)
+// Exemplo: R1=1M, R2=1M -> full-ohms = 2M, output-ohms = 1M -> razão 2.0
+#define BATTERY_DIVIDER_RATIO_Q10 \
+	((uint32_t)(((uint64_t)BATTERY_FULL_OHMS << 10) / BATTERY_OUTPUT_OHMS))
+
+// Temperatura de referência da curva de descarga (centésimos de °C)
+#define TEMP_REF_CDEG            2500
+
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+#define TEMP_NODE                DT_NODELABEL(temp)
+#define CALIB_THRESHOLD_CDEG     (CONFIG_HAL_BATTERY_CALIB_THRESHOLD_C * 100)
+#endif
+
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING)
+// Limiar do comparador POF (ex.: 22 -> NRF_POWER_POFTHR_V22 = 2,2 V)
+#define POF_THRESHOLD            UTIL_CAT(NRF_POWER_POFTHR_V, CONFIG_HAL_BATTERY_POF_THRESHOLD_DV)
+#endif
 
 /*******************************************************************************
  * VARIÁVEIS PRIVADAS
  ******************************************************************************/
 
+#if !defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
 // Device handle do ADC
 static const struct device *adc_dev;
 
 // Configuração do canal ADC
+#if defined(ADC_CHANNEL_NODE)
+// Canal descrito no devicetree: a entrada (VDD ou AINx) e o tempo de
+// aquisição acompanham a fiação da bateria de cada variante
+static struct adc_channel_cfg channel_cfg = ADC_CHANNEL_CFG_DT(ADC_CHANNEL_NODE);
+#else
 static struct adc_channel_cfg channel_cfg = {
 	.gain = ADC_GAIN,
 	.reference = ADC_REFERENCE,
@@ -86,122 +178,930 @@ static struct adc_channel_cfg channel_cfg = {
 	.input_positive = SAADC_CH_PSELP_PSELP_VDD,  // VDD para nRF52
 #endif
 };
+#endif
+
+// Buffer para leitura
+static int16_t adc_sample_buffer[ADC_SAMPLES];
+
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_SOFTWARE)
+// Conversões extras feitas pelo driver na mesma sequence
+static const struct adc_sequence_options sequence_options = {
+	.interval_us = ADC_SAMPLE_INTERVAL_US,
+	.extra_samplings = ADC_SAMPLES - 1,
+};
+#endif
 
 // Sequence de leitura
+// Com oversampling != 0 o driver nRF SAADC ativa o modo burst no canal
 static struct adc_sequence sequence = {
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_SOFTWARE)
+	.options = &sequence_options,
+#endif
 	.channels = BIT(ADC_CHANNEL),
+	.buffer = adc_sample_buffer,
+	.buffer_size = sizeof(adc_sample_buffer),
 	.resolution = ADC_RESOLUTION,
+	.oversampling = ADC_OVERSAMPLING,
 };
 
-// Buffer para leitura
-static int16_t adc_sample_buffer[ADC_SAMPLES];
+// Fim da sequence assíncrona: sinal levantado pelo driver (interrupção)
+// e tratado por adc_done_work na work queue do sistema
+static struct k_poll_signal adc_signal;
+static struct k_poll_event adc_event;
+static struct k_work_poll adc_done_work;
+static uint32_t adc_start_cycles = 0;  // Disparo da sequence (latência da conversão)
+static uint32_t adc_cpu_cycles = 0;    // CPU ativa no disparo (somada ao tratamento)
+
+// Calibração de offset do SAADC (acessado apenas na work queue do sistema)
+static bool adc_calibrated = false;
+
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+// Temperatura da última calibração (acessado apenas na work queue do sistema)
+static int32_t calib_temp_cdeg = TEMP_REF_CDEG;
+#endif
+#endif /* !CONFIG_HAL_BATTERY_SAMPLING_PPI */
+
+// Pedidos de leitura assíncrona (protegidos por async_lock): os que
+// aguardam a conversão em andamento e os que aguardam a próxima
+static struct k_spinlock async_lock;
+static sys_slist_t async_current;
+static sys_slist_t async_pending;
+static bool async_in_flight = false;  // Conversão em andamento
+static bool async_exclusive = false;  // Conversão em andamento não compartilhável
+
+// Work item que inicia a conversão fora do contexto do chamador
+static struct k_work adc_start_work;
+
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+// Sensor de temperatura do die
+static const struct device *const temp_dev = DEVICE_DT_GET(TEMP_NODE);
+#endif
+
+// Última temperatura do die em centésimos de °C (protegido por cache_lock)
+static int32_t die_temp_cdeg = TEMP_REF_CDEG;
+
+// Estado do módulo
+static bool initialized = false;
+static hal_battery_info_t last_reading = {
+	.voltage_mv = 0,
+	.loaded_mv = 0,
+	.effective_mv = 0,
+	.percentage = 0,
+	.state = HAL_BATTERY_STATE_UNKNOWN,
+};
+
+// Snapshot em cache (protegido por spinlock para leitura em qualquer contexto)
+static struct k_spinlock cache_lock;
+static int64_t last_reading_ms = 0;   // k_uptime_get() da última leitura
+static uint32_t last_reading_seq = 0; // Número de sequência da última leitura
+static bool last_reading_valid = false;
+
+// Work item para amostragem periódica em segundo plano
+static struct k_work_delayable sample_work;
+static void sample_read_done(int result, uint16_t voltage_mv, void *user_data);
+static hal_battery_read_req_t sample_req = {
+	.cb = sample_read_done,
+};
+
+// Medição sob carga (queda em relação ao repouso, protegida por cache_lock)
+static struct k_work_delayable loaded_work;
+static uint16_t load_sag_mv = 0;      // Repouso - sob carga na última medição
+static int64_t load_sag_ms = 0;       // k_uptime_get() da última medição
+static bool load_sag_valid = false;
+
+// Carga sinalizada pela aplicação (hal_battery_sample_loaded() até
+// hal_battery_load_ended()); a época muda a cada fim de carga
+static atomic_t load_on = ATOMIC_INIT(0);
+static atomic_t load_epoch = ATOMIC_INIT(0);
+
+// Conversão exclusiva: não pode aproveitar uma leitura em repouso
+static void loaded_read_done(int result, uint16_t voltage_mv, void *user_data);
+static hal_battery_read_req_t loaded_req = {
+	.cb = loaded_read_done,
+	.exclusive = true,
+};
+
+// Callbacks notificados a cada amostragem periódica
+#define MAX_SAMPLE_CBS      4
+static hal_battery_sample_cb_t sample_cbs[MAX_SAMPLE_CBS];
+static uint8_t sample_cb_count = 0;
+
+// Callbacks notificados no evento de bateria crítica
+#define MAX_CRITICAL_CBS    2
+static hal_battery_critical_cb_t critical_cbs[MAX_CRITICAL_CBS];
+static uint8_t critical_cb_count = 0;
+
+// Evento de bateria crítica por hardware (comparador POF ou limite do
+// SAADC no modo PPI) ocorreu e ainda não foi desmentido em repouso
+static atomic_t critical_latched = ATOMIC_INIT(0);
+
+// Leituras em repouso consecutivas acima do estado crítico desde o evento
+static atomic_t critical_release_count = ATOMIC_INIT(0);
+static void critical_release_check(uint16_t voltage_mv);
+
+// Work item que leva o evento crítico da ISR para a work queue do sistema
+static struct k_work critical_work;
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - ADC
+ ******************************************************************************/
+
+/**
+ * @brief Converte valor ADC raw para milivolts
+ * 
+ * @param adc_value Valor raw do ADC
+ * @return Tensão em milivolts
+ */
+static uint16_t adc_raw_to_mv(int16_t adc_value)
+{
+	// Conversão: (adc_value / adc_max) * vref * divider_ratio
+	uint32_t adc_max = (1 << ADC_RESOLUTION) - 1;
+	uint32_t voltage_mv = ((uint32_t)adc_value * ADC_VREF_MV) / adc_max;
+	
+	// Aplica razão do divisor resistivo (ponto fixo, sem float)
+	voltage_mv = (voltage_mv * BATTERY_DIVIDER_RATIO_Q10) >> 10;
+	
+	return (uint16_t)voltage_mv;
+}
+
+/**
+ * @brief Lê a temperatura do die
+ * 
+ * Chamada na work queue do sistema, antes de cada conversão. Sem
+ * compensação de temperatura, não faz nada.
+ * 
+ * @param temp_cdeg Ponteiro para armazenar a temperatura (centésimos de °C)
+ * @return true se a temperatura foi lida
+ */
+static bool die_temperature_update(int32_t *temp_cdeg)
+{
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+	struct sensor_value val;
+	int ret = sensor_sample_fetch(temp_dev);
+	
+	if (ret == 0) 
+	{
+		ret = sensor_channel_get(temp_dev, SENSOR_CHAN_DIE_TEMP, &val);
+	}
+	
+	if (ret < 0) 
+	{
+		LOG_WRN("Falha ao ler temperatura do die (err %d)", ret);
+		return false;
+	}
+	
+	*temp_cdeg = val.val1 * 100 + val.val2 / 10000;
+	
+	LOG_DBG("Temperatura do die: %d.%02d °C", *temp_cdeg / 100, abs(*temp_cdeg % 100));
+	
+	k_spinlock_key_t key = k_spin_lock(&cache_lock);
+	die_temp_cdeg = *temp_cdeg;
+	k_spin_unlock(&cache_lock, key);
+	
+	return true;
+#else
+	ARG_UNUSED(temp_cdeg);
+	return false;
+#endif
+}
+
+#if !defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+
+/**
+ * @brief Lê a temperatura do die e decide se o SAADC deve ser calibrado
+ * 
+ * Chamada na work queue do sistema, antes de cada conversão. A calibração
+ * de offset é solicitada via sequence.calibrate na primeira leitura e, com
+ * compensação de temperatura, sempre que a temperatura se afasta da
+ * temperatura da última calibração por CONFIG_HAL_BATTERY_CALIB_THRESHOLD_C.
+ */
+static void adc_prepare_calibration(void)
+{
+	bool calibrate = !adc_calibrated;
+	int32_t temp_cdeg;
+	
+	if (die_temperature_update(&temp_cdeg)) 
+	{
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+		if (abs(temp_cdeg - calib_temp_cdeg) >= CALIB_THRESHOLD_CDEG) 
+		{
+			calibrate = true;
+		}
+		
+		if (calibrate) 
+		{
+			calib_temp_cdeg = temp_cdeg;
+		}
+#endif
+	}
+	
+	if (calibrate) 
+	{
+		LOG_INF("Calibrando offset do SAADC");
+	}
+	
+	sequence.calibrate = calibrate;
+	adc_calibrated = true;
+}
+
+#endif /* !CONFIG_HAL_BATTERY_SAMPLING_PPI */
+
+#if !defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+
+/**
+ * @brief Calcula a média das conversões válidas do buffer da sequence
+ * 
+ * Com oversampling em hardware o buffer contém uma única conversão, já
+ * com a média das 2^ADC_OVERSAMPLING amostras feita pelo SAADC.
+ * 
+ * @param avg_raw Ponteiro para armazenar o valor raw médio
+ * @return 0 em sucesso, < 0 em erro
+ */
+static int adc_buffer_average(int16_t *avg_raw)
+{
+	int32_t sum = 0;
+	uint8_t valid_samples = 0;
+	
+	for (int i = 0; i < ADC_SAMPLES; i++) 
+	{
+		int16_t raw_value = adc_sample_buffer[i];
+		
+		// Valida leitura (ignora valores negativos ou saturados)
+		if (raw_value >= 0 && raw_value < (1 << ADC_RESOLUTION)) 
+		{
+			sum += raw_value;
+			valid_samples++;
+		}
+	}
+	
+	if (valid_samples == 0) 
+	{
+		LOG_ERR("Nenhuma leitura ADC válida");
+		return -EIO;
+	}
+	
+	// Calcula média
+	*avg_raw = sum / valid_samples;
+	
+	return 0;
+}
+
+#endif /* !CONFIG_HAL_BATTERY_SAMPLING_PPI */
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - LEITURA ASSÍNCRONA
+ ******************************************************************************/
+
+/**
+ * @brief Inicia a próxima conversão, se houver pedidos aguardando
+ * 
+ * Chamada com async_lock adquirido e nenhuma conversão em andamento. Um
+ * pedido exclusivo segue sozinho; caso contrário, todos os pedidos
+ * compartilháveis da fila seguem juntos na mesma conversão.
+ */
+static void async_start_next_locked(void)
+{
+	sys_snode_t *node = sys_slist_get(&async_pending);
+	
+	if (node == NULL) 
+	{
+		return;
+	}
+	
+	hal_battery_read_req_t *req = CONTAINER_OF(node, hal_battery_read_req_t, node);
+	
+	sys_slist_append(&async_current, node);
+	async_exclusive = req->exclusive;
+	
+	if (!async_exclusive) 
+	{
+		sys_snode_t *prev = NULL;
+		sys_snode_t *next;
+		
+		SYS_SLIST_FOR_EACH_NODE_SAFE(&async_pending, node, next)
+		{
+			req = CONTAINER_OF(node, hal_battery_read_req_t, node);
+			
+			if (req->exclusive) 
+			{
+				prev = node;
+				continue;
+			}
+			
+			sys_slist_remove(&async_pending, prev, node);
+			sys_slist_append(&async_current, node);
+		}
+	}
+	
+	async_in_flight = true;
+	k_work_submit(&adc_start_work);
+}
+
+/**
+ * @brief Conclui a conversão em andamento e avisa todos os seus pedidos
+ * 
+ * Executada na work queue do sistema. A próxima conversão (se houver
+ * pedidos na fila) é iniciada antes dos callbacks, que podem fazer novos
+ * pedidos.
+ * 
+ * @param ret Resultado da conversão (0 ou < 0 em erro)
+ * @param voltage_mv Tensão lida (válida apenas em sucesso)
+ */
+static void async_complete(int ret, uint16_t voltage_mv)
+{
+	hal_battery_read_req_t *req;
+	hal_battery_read_req_t *next;
+	int result = (ret < 0) ? HAL_BATTERY_ERROR_READ : HAL_BATTERY_SUCCESS;
+	
+	k_spinlock_key_t key = k_spin_lock(&async_lock);
+	
+	sys_slist_t done = async_current;
+	sys_slist_init(&async_current);
+	async_in_flight = false;
+	async_start_next_locked();
+	
+	k_spin_unlock(&async_lock, key);
+	
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&done, req, next, node)
+	{
+		req->cb(result, voltage_mv, req->user_data);
+	}
+}
+
+#if !defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+
+/**
+ * @brief Inicia uma conversão assíncrona do ADC
+ * 
+ * A sequence é disparada com adc_read_async(): o chamador não espera o
+ * oversampling, e o fim da conversão é tratado por adc_done_work.
+ * 
+ * @return 0 em sucesso, < 0 em erro (nenhuma conversão foi iniciada)
+ */
+static int adc_conversion_start(void)
+{
+	uint32_t cpu_start = k_cycle_get_32();
+	
+	adc_prepare_calibration();
+	
+	k_poll_signal_reset(&adc_signal);
+	k_poll_event_init(&adc_event, K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &adc_signal);
+	
+	int ret = k_work_poll_submit(&adc_done_work, &adc_event, 1, K_FOREVER);
+	if (ret < 0) 
+	{
+		LOG_ERR("Falha ao aguardar conversão ADC: %d", ret);
+		return ret;
+	}
+	
+	adc_start_cycles = k_cycle_get_32();
+	
+	ret = adc_read_async(adc_dev, &sequence, &adc_signal);
+	if (ret < 0) 
+	{
+		LOG_ERR("Erro ao iniciar leitura ADC: %d", ret);
+		k_work_poll_cancel(&adc_done_work);
+		
+		// Calibração não concluída: tenta novamente na próxima leitura
+		if (sequence.calibrate) 
+		{
+			adc_calibrated = false;
+		}
+		
+		sequence.calibrate = false;
+		return ret;
+	}
+	
+	adc_cpu_cycles = k_cycle_get_32() - cpu_start;
+	
+	return 0;
+}
+
+/**
+ * @brief Handler do fim da conversão assíncrona
+ * 
+ * Executado na work queue do sistema quando o driver sinaliza o fim da
+ * sequence. O log de debug registra o tempo de CPU ativa da leitura
+ * (disparo + tratamento, sem a espera da conversão) e a latência entre
+ * o disparo e o tratamento, para acompanhamento do consumo.
+ */
+static void adc_done_work_handler(struct k_work *work)
+{
+	unsigned int signaled;
+	int result;
+	int16_t avg_raw;
+	uint16_t voltage_mv = 0;
+	
+	uint32_t cpu_start = k_cycle_get_32();
+	uint32_t latency_us = k_cyc_to_us_floor32(cpu_start - adc_start_cycles);
+	
+	k_poll_signal_check(&adc_signal, &signaled, &result);
+	
+	int ret = result;
+	
+	if (!signaled || result < 0) 
+	{
+		LOG_ERR("Erro na leitura ADC: %d", result);
+		ret = -EIO;
+	}
+	else 
+	{
+		ret = adc_buffer_average(&avg_raw);
+	}
+	
+	if (ret < 0 && sequence.calibrate) 
+	{
+		// Calibração não concluída: tenta novamente na próxima leitura
+		adc_calibrated = false;
+	}
+	
+	sequence.calibrate = false;
+	
+	if (ret == 0) 
+	{
+		voltage_mv = adc_raw_to_mv(avg_raw);
+		
+		uint32_t cpu_us = k_cyc_to_us_floor32(adc_cpu_cycles + (k_cycle_get_32() - cpu_start));
+		
+		LOG_DBG("ADC raw avg: %d, voltage: %d mV (CPU %u us, latência %u us)",
+		        avg_raw, voltage_mv, cpu_us, latency_us);
+	}
+	
+	async_complete(ret, voltage_mv);
+}
+
+#else /* CONFIG_HAL_BATTERY_SAMPLING_PPI */
+
+/**
+ * @brief Obtém a média do último buffer adquirido por hardware
+ * 
+ * No modo PPI não há conversão sob demanda: as conversões são disparadas
+ * pelo RTC via PPI e a leitura é concluída imediatamente com a média do
+ * último buffer completo.
+ * 
+ * @return 0 em sucesso, < 0 em erro
+ */
+static int adc_conversion_start(void)
+{
+	int16_t avg_raw;
+	int32_t temp_cdeg;
+	
+	// SAADC calibrado na inicialização do backend; apenas a temperatura
+	// é atualizada para a compensação
+	die_temperature_update(&temp_cdeg);
+	
+	int ret = battery_ppi_get_average(&avg_raw);
+	if (ret < 0) 
+	{
+		return ret;
+	}
+	
+	async_complete(0, adc_raw_to_mv(avg_raw));
+	
+	return 0;
+}
+
+#endif /* !CONFIG_HAL_BATTERY_SAMPLING_PPI */
+
+/**
+ * @brief Handler que inicia a conversão na work queue do sistema
+ * 
+ * Mantém hal_battery_read_voltage_async() seguro em qualquer contexto:
+ * a leitura de temperatura e o disparo do ADC nunca rodam no chamador.
+ */
+static void adc_start_work_handler(struct k_work *work)
+{
+	int ret = adc_conversion_start();
+	if (ret < 0) 
+	{
+		async_complete(ret, 0);
+	}
+}
+
+/**
+ * @brief Contexto de uma leitura síncrona sobre a leitura assíncrona
+ */
+struct sync_read {
+	hal_battery_read_req_t req;
+	struct k_sem done;
+	int result;
+	uint16_t voltage_mv;
+};
+
+/**
+ * @brief Conclusão de uma leitura síncrona: acorda a thread que aguarda
+ */
+static void sync_read_done(int result, uint16_t voltage_mv, void *user_data)
+{
+	struct sync_read *ctx = user_data;
+	
+	ctx->result = result;
+	ctx->voltage_mv = voltage_mv;
+	k_sem_give(&ctx->done);
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - CÁLCULOS
+ ******************************************************************************/
+
+/**
+ * @brief Interpola linearmente entre dois pontos
+ * 
+ * @param x Valor de entrada
+ * @param x0 Ponto inicial X
+ * @param y0 Ponto inicial Y
+ * @param x1 Ponto final X
+ * @param y1 Ponto final Y
+ * @return Valor interpolado Y
+ */
+static int32_t linear_interpolate(int32_t x, int32_t x0, int32_t y0, 
+                                   int32_t x1, int32_t y1)
+{
+	if (x <= x0) return y0;
+	if (x >= x1) return y1;
+	
+	return y0 + ((x - x0) * (y1 - y0)) / (x1 - x0);
+}
+
+/**
+ * @brief Corrige a tensão para a temperatura de referência da curva
+ * 
+ * A curva de descarga é caracterizada a 25 °C; no frio a bateria entrega
+ * menos tensão para a mesma carga restante.
+ * 
+ * @param voltage_mv Tensão medida
+ * @param temp_cdeg Temperatura do die em centésimos de °C
+ * @return Tensão equivalente a 25 °C
+ */
+static uint16_t temperature_compensate(uint16_t voltage_mv, int32_t temp_cdeg)
+{
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+	int32_t comp_mv = ((TEMP_REF_CDEG - temp_cdeg) * CONFIG_HAL_BATTERY_TEMP_COEFF_UV_PER_C) /
+	                  (100 * 1000);
+	
+	return (uint16_t)CLAMP((int32_t)voltage_mv + comp_mv, 0, UINT16_MAX);
+#else
+	ARG_UNUSED(temp_cdeg);
+	return voltage_mv;
+#endif
+}
+
+/**
+ * @brief Calcula percentual e estado a partir de uma leitura em repouso
+ * 
+ * Com medição sob carga recente, estima a tensão sob carga aplicando a
+ * queda medida à leitura em repouso e usa essa tensão no cálculo, para
+ * que o aviso crítico ocorra antes que o próprio alarme derrube a bateria.
+ * 
+ * @param info Informações com voltage_mv preenchido
+ */
+static void apply_load_model(hal_battery_info_t *info)
+{
+	k_spinlock_key_t key = k_spin_lock(&cache_lock);
+	
+	bool recent = load_sag_valid &&
+	              (k_uptime_get() - load_sag_ms) <= (int64_t)CONFIG_HAL_BATTERY_LOAD_MAX_AGE_S * 1000;
+	uint16_t sag_mv = load_sag_mv;
+	int32_t temp_cdeg = die_temp_cdeg;
+	
+	k_spin_unlock(&cache_lock, key);
+	
+	uint16_t effective_mv = info->voltage_mv;
+	info->loaded_mv = 0;
+	
+	if (recent) 
+	{
+		effective_mv = (info->voltage_mv > sag_mv) ? (info->voltage_mv - sag_mv) : 0;
+		info->loaded_mv = effective_mv;
+	}
+	
+	effective_mv = temperature_compensate(effective_mv, temp_cdeg);
+	info->effective_mv = effective_mv;
+	
+	info->percentage = hal_battery_voltage_to_percentage(effective_mv);
+	info->state = hal_battery_percentage_to_state(info->percentage);
+	
+	// Bateria caiu abaixo do limiar de hardware: crítico até que as
+	// leituras em repouso o desmintam (critical_release_check())
+	if (atomic_get(&critical_latched)) 
+	{
+		info->state = HAL_BATTERY_STATE_CRITICAL;
+	}
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - CACHE E AMOSTRAGEM PERIÓDICA
+ ******************************************************************************/
+
+/**
+ * @brief Armazena uma nova leitura no snapshot em cache
+ * 
+ * @param info Leitura completa a ser armazenada
+ */
+static void cache_store(const hal_battery_info_t *info)
+{
+	k_spinlock_key_t key = k_spin_lock(&cache_lock);
+	
+	last_reading = *info;
+	last_reading_ms = k_uptime_get();
+	last_reading_seq++;
+	last_reading_valid = true;
+	
+	k_spin_unlock(&cache_lock, key);
+}
+
+/**
+ * @brief Calcula as informações de uma leitura em repouso e atualiza o cache
+ * 
+ * @param voltage_mv Tensão em repouso lida
+ * @param info Estrutura onde as informações serão armazenadas
+ */
+static void battery_info_update(uint16_t voltage_mv, hal_battery_info_t *info)
+{
+	info->voltage_mv = voltage_mv;
+	critical_release_check(voltage_mv);
+	apply_load_model(info);
+	cache_store(info);
+	
+	LOG_DBG("Bateria: %d mV (sob carga %d mV), %d%%, estado: %d", 
+	        voltage_mv, info->loaded_mv, info->percentage, info->state);
+}
+
+/**
+ * @brief Conclusão da leitura da amostragem periódica
+ * 
+ * Atualiza o cache, repassa a nova amostra aos consumidores registrados
+ * e reagenda a amostragem.
+ */
+static void sample_read_done(int result, uint16_t voltage_mv, void *user_data)
+{
+	hal_battery_info_t info;
+	
+	if (result != HAL_BATTERY_SUCCESS) 
+	{
+		LOG_WRN("Amostragem periódica da bateria falhou");
+	}
+	else 
+	{
+		battery_info_update(voltage_mv, &info);
+		
+		// Repassa a nova amostra aos consumidores registrados
+		for (uint8_t i = 0; i < sample_cb_count; i++) 
+		{
+			sample_cbs[i](&info);
+		}
+	}
+	
+#if !defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+	k_work_schedule(&sample_work, K_MSEC(CONFIG_HAL_BATTERY_SAMPLE_INTERVAL_MS));
+#endif
+}
+
+/**
+ * @brief Handler da amostragem periódica
+ * 
+ * Executa na work queue do sistema, fora dos contextos sensíveis a
+ * latência (ex.: thread RX do Bluetooth). A leitura é assíncrona e
+ * aproveita uma conversão já em andamento, se houver; a conclusão
+ * reagenda a amostragem. No modo PPI, é submetido a cada buffer completo
+ * da aquisição por hardware.
+ */
+static void sample_work_handler(struct k_work *work)
+{
+	hal_battery_read_voltage_async(&sample_req);
+}
+
+/**
+ * @brief Handler da medição sob carga
+ * 
+ * Dispara uma conversão exclusiva com a carga ativa. A época da carga
+ * acompanha o pedido: a conversão pode ficar na fila atrás de outras e
+ * terminar depois que a carga se desligou.
+ */
+static void loaded_work_handler(struct k_work *work)
+{
+	if (!atomic_get(&load_on)) 
+	{
+		return;
+	}
+	
+	loaded_req.user_data = UINT_TO_POINTER(atomic_get(&load_epoch));
+	hal_battery_read_voltage_async(&loaded_req);
+}
+
+/**
+ * @brief Conclusão da medição sob carga
+ * 
+ * Registra a queda em relação à última leitura em repouso. O snapshot em
+ * cache é recalculado com a nova queda e repassado aos consumidores
+ * registrados. A leitura é descartada se a carga se desligou desde o
+ * disparo: mediria uma queda próxima de zero.
+ */
+static void loaded_read_done(int result, uint16_t loaded_mv, void *user_data)
+{
+	if (result != HAL_BATTERY_SUCCESS) 
+	{
+		LOG_WRN("Medição sob carga falhou");
+		return;
+	}
+	
+	if (!atomic_get(&load_on) ||
+	    POINTER_TO_UINT(user_data) != (unsigned int)atomic_get(&load_epoch)) 
+	{
+		LOG_DBG("Carga desligada durante a medição, leitura descartada");
+		return;
+	}
+	
+	k_spinlock_key_t key = k_spin_lock(&cache_lock);
+	
+	bool has_resting = last_reading_valid;
+	hal_battery_info_t info = last_reading;
+	uint16_t sag_mv = (info.voltage_mv > loaded_mv) ? (info.voltage_mv - loaded_mv) : 0;
+	
+	if (has_resting) 
+	{
+		load_sag_mv = sag_mv;
+		load_sag_ms = k_uptime_get();
+		load_sag_valid = true;
+	}
+	
+	k_spin_unlock(&cache_lock, key);
+	
+	if (!has_resting) 
+	{
+		LOG_WRN("Medição sob carga sem leitura em repouso de referência");
+		return;
+	}
+	
+	LOG_INF("Bateria sob carga: %d mV (repouso %d mV, queda %d mV)",
+	        loaded_mv, info.voltage_mv, sag_mv);
+	
+	// Recalcula percentual e estado com a nova queda
+	apply_load_model(&info);
+	cache_store(&info);
+	
+	for (uint8_t i = 0; i < sample_cb_count; i++) 
+	{
+		sample_cbs[i](&info);
+	}
+}
+
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING) || defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+
+/**
+ * @brief Registra o evento de bateria crítica (seguro em interrupção)
+ * 
+ * O evento fica travado até que CONFIG_HAL_BATTERY_CRITICAL_RELEASE_SAMPLES
+ * leituras em repouso consecutivas fiquem acima do estado crítico.
+ */
+static void critical_latch(void)
+{
+	atomic_clear(&critical_release_count);
+	
+	if (atomic_set(&critical_latched, 1) == 0) 
+	{
+		k_work_submit(&critical_work);
+	}
+}
+
+#endif
+
+/**
+ * @brief Propaga o evento de bateria crítica na work queue do sistema
+ * 
+ * Atualiza o snapshot em cache para o estado crítico (sem ler o ADC) e
+ * avisa os consumidores: primeiro os callbacks de bateria crítica, depois
+ * os de amostragem.
+ */
+static void critical_work_handler(struct k_work *work)
+{
+	LOG_WRN("Evento de bateria crítica por hardware");
+	
+	k_spinlock_key_t key = k_spin_lock(&cache_lock);
+	bool valid = last_reading_valid;
+	hal_battery_info_t info = last_reading;
+	k_spin_unlock(&cache_lock, key);
+	
+	info.state = HAL_BATTERY_STATE_CRITICAL;
+	
+	if (valid) 
+	{
+		cache_store(&info);
+	}
+	
+	for (uint8_t i = 0; i < critical_cb_count; i++) 
+	{
+		critical_cbs[i]();
+	}
+	
+	if (valid) 
+	{
+		for (uint8_t i = 0; i < sample_cb_count; i++) 
+		{
+			sample_cbs[i](&info);
+		}
+	}
+}
+
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING)
+
+/**
+ * @brief Handler do evento POFWARN (contexto de interrupção)
+ * 
+ * O comparador é desarmado no primeiro evento: VDD oscilando no limiar
+ * geraria uma rajada de interrupções.
+ */
+static void pof_handler(void)
+{
+	nrfx_power_pof_disable();
+	critical_latch();
+}
+
+/**
+ * @brief Arma o comparador POF no limiar configurado
+ */
+static void pof_arm(void)
+{
+	nrfx_power_pofwarn_config_t pof_config = {
+		.handler = pof_handler,
+		.thr = POF_THRESHOLD,
+	};
+	
+	nrfx_power_pof_init(&pof_config);
+	nrfx_power_pof_enable(&pof_config);
+	
+	LOG_INF("Comparador POF armado em %d.%d V", CONFIG_HAL_BATTERY_POF_THRESHOLD_DV / 10,
+	        CONFIG_HAL_BATTERY_POF_THRESHOLD_DV % 10);
+}
 
-// Estado do módulo
-static bool initialized = false;
-static hal_battery_info_t last_reading = {
-	.voltage_mv = 0,
-	.percentage = 0,
-	.state = HAL_BATTERY_STATE_UNKNOWN,
-};
+#endif /* CONFIG_HAL_BATTERY_POF_WARNING */
 
-/*******************************************************************************
- * FUNÇÕES PRIVADAS - ADC
- ******************************************************************************/
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
 
 /**
- * @brief Converte valor ADC raw para milivolts
- * 
- * @param adc_value Valor raw do ADC
- * @return Tensão em milivolts
+ * @brief Converte milivolts para valor raw do ADC (inversa de adc_raw_to_mv)
  */
-static uint16_t adc_raw_to_mv(int16_t adc_value)
+static int16_t adc_mv_to_raw(uint16_t voltage_mv)
 {
-	// Conversão: (adc_value / adc_max) * vref * divider_ratio
 	uint32_t adc_max = (1 << ADC_RESOLUTION) - 1;
-	uint32_t voltage_mv = ((uint32_t)adc_value * ADC_VREF_MV) / adc_max;
-	
-	// Aplica razão do divisor resistivo
-	voltage_mv = (uint32_t)((float)voltage_mv * BATTERY_DIVIDER_RATIO);
+	uint32_t input_mv = ((uint32_t)voltage_mv << 10) / BATTERY_DIVIDER_RATIO_Q10;
 	
-	return (uint16_t)voltage_mv;
+	return (int16_t)MIN((input_mv * adc_max) / ADC_VREF_MV, adc_max);
+}
+
+/**
+ * @brief Buffer de aquisição por hardware completo (contexto de interrupção)
+ */
+static void ppi_done_handler(void)
+{
+	k_work_reschedule(&sample_work, K_NO_WAIT);
 }
 
+#endif /* CONFIG_HAL_BATTERY_SAMPLING_PPI */
+
 /**
- * @brief Realiza leitura do ADC com oversampling
+ * @brief Libera o evento crítico de hardware após leituras em repouso normais
  * 
- * @param voltage_mv Ponteiro para armazenar tensão lida
- * @return 0 em sucesso, < 0 em erro
+ * O comparador costuma disparar sob a carga do buzzer: se as leituras em
+ * repouso seguintes ficam acima do estado crítico, a queda foi transitória
+ * e o limiar de hardware é rearmado.
+ * 
+ * @param voltage_mv Tensão em repouso lida
  */
-static int adc_read_with_oversampling(uint16_t *voltage_mv)
+static void critical_release_check(uint16_t voltage_mv)
 {
-	int ret;
-	int32_t sum = 0;
-	uint8_t valid_samples = 0;
-	
-	// Configura buffer no sequence
-	sequence.buffer = adc_sample_buffer;
-	sequence.buffer_size = sizeof(adc_sample_buffer);
-	
-	// Realiza múltiplas leituras
-	for (int i = 0; i < ADC_SAMPLES; i++) 
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING) || defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+	if (CONFIG_HAL_BATTERY_CRITICAL_RELEASE_SAMPLES == 0 || !atomic_get(&critical_latched)) 
 	{
-		ret = adc_read(adc_dev, &sequence);
-		if (ret < 0) 
-		{
-			LOG_ERR("Erro na leitura ADC: %d", ret);
-			continue;
-		}
-		
-		int16_t raw_value = adc_sample_buffer[0];
-		
-		// Valida leitura (ignora valores negativos ou saturados)
-		if (raw_value >= 0 && raw_value < (1 << ADC_RESOLUTION)) 
-		{
-			sum += raw_value;
-			valid_samples++;
-		}
-		
-		// Pequeno delay entre leituras
-		k_msleep(1);
+		return;
 	}
 	
-	if (valid_samples == 0) 
+	uint8_t percentage = hal_battery_voltage_to_percentage(voltage_mv);
+	if (hal_battery_percentage_to_state(percentage) == HAL_BATTERY_STATE_CRITICAL) 
 	{
-		LOG_ERR("Nenhuma leitura ADC válida");
-		return -EIO;
+		atomic_clear(&critical_release_count);
+		return;
 	}
 	
-	// Calcula média
-	int16_t avg_raw = sum / valid_samples;
-	*voltage_mv = adc_raw_to_mv(avg_raw);
+	if (atomic_inc(&critical_release_count) + 1 < CONFIG_HAL_BATTERY_CRITICAL_RELEASE_SAMPLES) 
+	{
+		return;
+	}
 	
-	LOG_DBG("ADC raw avg: %d, voltage: %d mV (%d samples)", 
-	        avg_raw, *voltage_mv, valid_samples);
+	atomic_clear(&critical_release_count);
+	atomic_clear(&critical_latched);
 	
-	return 0;
-}
-
-/*******************************************************************************
- * FUNÇÕES PRIVADAS - CÁLCULOS
- ******************************************************************************/
-
-/**
- * @brief Interpola linearmente entre dois pontos
- * 
- * @param x Valor de entrada
- * @param x0 Ponto inicial X
- * @param y0 Ponto inicial Y
- * @param x1 Ponto final X
- * @param y1 Ponto final Y
- * @return Valor interpolado Y
- */
-static int32_t linear_interpolate(int32_t x, int32_t x0, int32_t y0, 
-                                   int32_t x1, int32_t y1)
-{
-	if (x <= x0) return y0;
-	if (x >= x1) return y1;
+	LOG_INF("Bateria em repouso em %d mV: evento crítico de hardware liberado", voltage_mv);
 	
-	return y0 + ((x - x0) * (y1 - y0)) / (x1 - x0);
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING)
+	pof_arm();
+#endif
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+	battery_ppi_limit_rearm();
+#endif
+#else
+	ARG_UNUSED(voltage_mv);
+#endif
 }
 
 /*******************************************************************************
@@ -216,6 +1116,49 @@ int hal_battery_init(void)
 		return HAL_BATTERY_SUCCESS;
 	}
 	
+	// Valida a curva de descarga (tensões estritamente decrescentes)
+	for (size_t i = 1; i < CURVE_POINTS; i++) 
+	{
+		if (curve_mv[i] >= curve_mv[i - 1]) 
+		{
+			LOG_ERR("Curva de descarga inválida no ponto %d", (int)i);
+			return HAL_BATTERY_ERROR_INIT;
+		}
+	}
+	
+#if defined(CONFIG_HAL_BATTERY_TEMP_COMPENSATION)
+	if (!device_is_ready(temp_dev)) 
+	{
+		LOG_ERR("Sensor de temperatura do die não está pronto");
+		return HAL_BATTERY_ERROR_INIT;
+	}
+#endif
+	
+	k_work_init_delayable(&sample_work, sample_work_handler);
+	k_work_init_delayable(&loaded_work, loaded_work_handler);
+	k_work_init(&adc_start_work, adc_start_work_handler);
+	k_work_init(&critical_work, critical_work_handler);
+	
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+	// Aquisição por hardware: a CPU só acorda a cada buffer completo ou
+	// quando a tensão fica abaixo do limiar crítico
+	uint16_t critical_mv = hal_battery_percentage_to_voltage(PPI_CRITICAL_PCT);
+	int ret = battery_ppi_init(PPI_SAMPLE_PERIOD_MS, adc_mv_to_raw(critical_mv),
+	                           ppi_done_handler, critical_latch);
+	if (ret < 0) 
+	{
+		LOG_ERR("Falha ao iniciar aquisição por hardware: %d", ret);
+		return HAL_BATTERY_ERROR_INIT;
+	}
+	
+	initialized = true;
+	
+	LOG_INF("HAL Battery inicializado (aquisição por hardware, limiar %d mV)",
+	        critical_mv);
+#else
+	k_poll_signal_init(&adc_signal);
+	k_work_poll_init(&adc_done_work, adc_done_work_handler);
+	
 	// Obtém device do ADC
 	adc_dev = DEVICE_DT_GET(ADC_NODE);
 	if (!device_is_ready(adc_dev)) 
@@ -226,7 +1169,7 @@ int hal_battery_init(void)
 	
 	// Configura canal ADC
 	int ret = adc_channel_setup(adc_dev, &channel_cfg);
-
+	
 	if (ret < 0) 
 	{
 		LOG_ERR("Falha ao configurar canal ADC: %d", ret);
@@ -248,6 +1191,14 @@ int hal_battery_init(void)
 		LOG_WRN("HAL Battery inicializado, mas leitura inicial falhou");
 	}
 	
+	// Inicia amostragem periódica em segundo plano
+	k_work_schedule(&sample_work, K_MSEC(CONFIG_HAL_BATTERY_SAMPLE_INTERVAL_MS));
+#endif /* CONFIG_HAL_BATTERY_SAMPLING_PPI */
+	
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING)
+	pof_arm();
+#endif
+	
 	return HAL_BATTERY_SUCCESS;
 }
 
@@ -259,69 +1210,127 @@ int hal_battery_read_voltage(uint16_t *voltage_mv)
 		return HAL_BATTERY_ERROR_STATE;
 	}
 	
-	if (voltage_mv == NULL)
+	if (voltage_mv == NULL) 
 	{
 		LOG_ERR("Ponteiro voltage_mv é NULL");
 		return HAL_BATTERY_ERROR_READ;
 	}
 	
-	int ret = adc_read_with_oversampling(voltage_mv);
-	if (ret < 0) 
+	// A conclusão roda na work queue do sistema: esperar nela travaria
+	if (k_current_get() == k_work_queue_thread_get(&k_sys_work_q)) 
+	{
+		LOG_ERR("Leitura síncrona na work queue do sistema, use a leitura assíncrona");
+		return HAL_BATTERY_ERROR_STATE;
+	}
+	
+	struct sync_read ctx = {
+		.req = {
+			.cb = sync_read_done,
+			.user_data = &ctx,
+		},
+	};
+	
+	k_sem_init(&ctx.done, 0, 1);
+	
+	int ret = hal_battery_read_voltage_async(&ctx.req);
+	if (ret != HAL_BATTERY_SUCCESS) 
+	{
+		return ret;
+	}
+	
+	k_sem_take(&ctx.done, K_FOREVER);
+	
+	if (ctx.result != HAL_BATTERY_SUCCESS) 
 	{
 		LOG_ERR("Erro ao ler tensão da bateria");
-		return HAL_BATTERY_ERROR_READ;
+		return ctx.result;
 	}
 	
+	*voltage_mv = ctx.voltage_mv;
+	
 	return HAL_BATTERY_SUCCESS;
 }
 
-uint8_t hal_battery_voltage_to_percentage(uint16_t voltage_mv)
+int hal_battery_read_voltage_async(hal_battery_read_req_t *req)
 {
-	int32_t percentage;
+	if (!initialized) 
+	{
+		return HAL_BATTERY_ERROR_STATE;
+	}
 	
-	// Interpolação por segmentos para melhor precisão
-	if (voltage_mv >= BATTERY_VOLTAGE_MAX_MV) 
+	if (req == NULL || req->cb == NULL) 
 	{
-		percentage = 100;
+		return HAL_BATTERY_ERROR_READ;
 	}
 	
-	else if (voltage_mv >= BATTERY_VOLTAGE_GOOD_MV) 
+	k_spinlock_key_t key = k_spin_lock(&async_lock);
+	
+	sys_snode_t *prev;
+	
+	// Pedido já aguardando uma conversão: nada a fazer
+	if (sys_slist_find(&async_current, &req->node, &prev) ||
+	    sys_slist_find(&async_pending, &req->node, &prev)) 
 	{
-		// 70% - 100%: 2.8V - 3.0V
-		percentage = linear_interpolate(voltage_mv,
-		                                BATTERY_VOLTAGE_GOOD_MV, 70,
-		                                BATTERY_VOLTAGE_MAX_MV, 100);
+		k_spin_unlock(&async_lock, key);
+		return HAL_BATTERY_SUCCESS;
 	}
 	
-	else if (voltage_mv >= BATTERY_VOLTAGE_LOW_MV) 
+	if (async_in_flight && !async_exclusive && !req->exclusive) 
+	{
+		// Compartilha a conversão em andamento
+		sys_slist_append(&async_current, &req->node);
+	}
+	else 
 	{
-		// 30% - 70%: 2.5V - 2.8V
-		percentage = linear_interpolate(voltage_mv,
-		                                BATTERY_VOLTAGE_LOW_MV, 30,
-		                                BATTERY_VOLTAGE_GOOD_MV, 70);
+		sys_slist_append(&async_pending, &req->node);
+		
+		if (!async_in_flight) 
+		{
+			async_start_next_locked();
+		}
 	}
 	
-	else if (voltage_mv >= BATTERY_VOLTAGE_CRIT_MV) 
+	k_spin_unlock(&async_lock, key);
+	
+	return HAL_BATTERY_SUCCESS;
+}
+
+uint8_t hal_battery_voltage_to_percentage(uint16_t voltage_mv)
+{
+	// Fora da curva: satura nos extremos
+	if (voltage_mv >= curve_mv[0]) 
 	{
-		// 10% - 30%: 2.2V - 2.5V
-		percentage = linear_interpolate(voltage_mv,
-		                                BATTERY_VOLTAGE_CRIT_MV, 10,
-		                                BATTERY_VOLTAGE_LOW_MV, 30);
+		return curve_pct[0];
 	}
 	
-	else if (voltage_mv >= BATTERY_VOLTAGE_MIN_MV) 
+	if (voltage_mv <= curve_mv[CURVE_POINTS - 1]) 
 	{
-		// 0% - 10%: 2.0V - 2.2V
-		percentage = linear_interpolate(voltage_mv,
-		                                BATTERY_VOLTAGE_MIN_MV, 0,
-		                                BATTERY_VOLTAGE_CRIT_MV, 10);
+		return curve_pct[CURVE_POINTS - 1];
 	}
 	
-	else 
+	// Busca binária pelo segmento: curve_mv[lo] > voltage_mv >= curve_mv[hi]
+	size_t lo = 0;
+	size_t hi = CURVE_POINTS - 1;
+	
+	while (hi - lo > 1) 
 	{
-		percentage = 0;
+		size_t mid = (lo + hi) / 2;
+		
+		if (voltage_mv >= curve_mv[mid]) 
+		{
+			hi = mid;
+		} 
+		else 
+		{
+			lo = mid;
+		}
 	}
 	
+	// Interpolação linear inteira dentro do segmento
+	int32_t percentage = linear_interpolate(voltage_mv,
+	                                        curve_mv[hi], curve_pct[hi],
+	                                        curve_mv[lo], curve_pct[lo]);
+	
 	// Garante range 0-100
 	if (percentage > 100) percentage = 100;
 	if (percentage < 0) percentage = 0;
@@ -329,6 +1338,33 @@ uint8_t hal_battery_voltage_to_percentage(uint16_t voltage_mv)
 	return (uint8_t)percentage;
 }
 
+uint16_t hal_battery_percentage_to_voltage(uint8_t percentage)
+{
+	// Fora da curva: satura nos extremos
+	if (percentage >= curve_pct[0]) 
+	{
+		return curve_mv[0];
+	}
+	
+	if (percentage <= curve_pct[CURVE_POINTS - 1]) 
+	{
+		return curve_mv[CURVE_POINTS - 1];
+	}
+	
+	// Primeiro segmento com curve_pct[i] > percentage >= curve_pct[i + 1]
+	size_t i = 0;
+	
+	while (percentage < curve_pct[i + 1]) 
+	{
+		i++;
+	}
+	
+	// Interpolação linear inteira dentro do segmento
+	return (uint16_t)linear_interpolate(percentage,
+	                                    curve_pct[i + 1], curve_mv[i + 1],
+	                                    curve_pct[i], curve_mv[i]);
+}
+
 hal_battery_state_t hal_battery_percentage_to_state(uint8_t percentage)
 {
 	if (percentage > 70) 
@@ -375,20 +1411,145 @@ int hal_battery_get_info(hal_battery_info_t *info)
 		return ret;
 	}
 	
-	// Calcula informações derivadas
-	uint8_t percentage = hal_battery_voltage_to_percentage(voltage_mv);
-	hal_battery_state_t state = hal_battery_percentage_to_state(percentage);
+	// Calcula informações derivadas e salva no cache
+	battery_info_update(voltage_mv, info);
 	
-	// Atualiza estrutura
-	info->voltage_mv = voltage_mv;
-	info->percentage = percentage;
-	info->state = state;
+	return HAL_BATTERY_SUCCESS;
+}
+
+int hal_battery_get_snapshot(hal_battery_snapshot_t *snapshot, uint32_t max_age_ms)
+{
+	if (!initialized) 
+	{
+		return HAL_BATTERY_ERROR_STATE;
+	}
 	
-	// Salva última leitura
-	last_reading = *info;
+	if (snapshot == NULL) 
+	{
+		return HAL_BATTERY_ERROR_READ;
+	}
+	
+	k_spinlock_key_t key = k_spin_lock(&cache_lock);
+	
+	bool valid = last_reading_valid;
+	int64_t age_ms = k_uptime_get() - last_reading_ms;
+	snapshot->info = last_reading;
+	snapshot->timestamp_ms = last_reading_ms;
+	snapshot->sequence = last_reading_seq;
+	
+	k_spin_unlock(&cache_lock, key);
+	
+	if (!valid) 
+	{
+		return HAL_BATTERY_ERROR_NO_DATA;
+	}
+	
+	if (age_ms > max_age_ms) 
+	{
+		// Antecipa a próxima amostragem periódica
+		k_work_reschedule(&sample_work, K_NO_WAIT);
+		return HAL_BATTERY_ERROR_STALE;
+	}
+	
+	return HAL_BATTERY_SUCCESS;
+}
+
+int hal_battery_get_cached(hal_battery_info_t *info, uint32_t max_age_ms)
+{
+	if (info == NULL) 
+	{
+		return HAL_BATTERY_ERROR_READ;
+	}
+	
+	hal_battery_snapshot_t snapshot;
+	int ret = hal_battery_get_snapshot(&snapshot, max_age_ms);
+	
+	if (ret == HAL_BATTERY_SUCCESS || ret == HAL_BATTERY_ERROR_STALE) 
+	{
+		*info = snapshot.info;
+	}
+	
+	return ret;
+}
+
+int hal_battery_sample_loaded(uint32_t delay_ms)
+{
+	if (!initialized) 
+	{
+		return HAL_BATTERY_ERROR_STATE;
+	}
+	
+#if defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+	// Sem conversão sob demanda: o limite do SAADC cobre as quedas sob carga
+	ARG_UNUSED(delay_ms);
+	return HAL_BATTERY_ERROR_STATE;
+#else
+	atomic_set(&load_on, 1);
+	
+	k_spinlock_key_t key = k_spin_lock(&cache_lock);
+	bool too_soon = load_sag_valid &&
+	                (k_uptime_get() - load_sag_ms) < CONFIG_HAL_BATTERY_LOAD_MIN_INTERVAL_MS;
+	k_spin_unlock(&cache_lock, key);
+	
+	if (too_soon || k_work_delayable_is_pending(&loaded_work)) 
+	{
+		return HAL_BATTERY_SUCCESS;
+	}
+	
+	k_work_schedule(&loaded_work, K_MSEC(delay_ms));
+	
+	return HAL_BATTERY_SUCCESS;
+#endif
+}
+
+void hal_battery_load_ended(void)
+{
+#if !defined(CONFIG_HAL_BATTERY_SAMPLING_PPI)
+	if (!initialized) 
+	{
+		return;
+	}
+	
+	atomic_set(&load_on, 0);
+	atomic_inc(&load_epoch);
+	k_work_cancel_delayable(&loaded_work);
+#endif
+}
+
+int hal_battery_register_sample_cb(hal_battery_sample_cb_t cb)
+{
+	if (cb == NULL) 
+	{
+		LOG_ERR("Callback de amostragem é NULL");
+		return HAL_BATTERY_ERROR_READ;
+	}
+	
+	if (sample_cb_count >= MAX_SAMPLE_CBS) 
+	{
+		LOG_ERR("Limite de callbacks de amostragem atingido");
+		return HAL_BATTERY_ERROR_STATE;
+	}
+	
+	sample_cbs[sample_cb_count++] = cb;
+	
+	return HAL_BATTERY_SUCCESS;
+}
+
+int hal_battery_register_critical_cb(hal_battery_critical_cb_t cb)
+{
+	if (cb == NULL) 
+	{
+		LOG_ERR("Callback de bateria crítica é NULL");
+		return HAL_BATTERY_ERROR_READ;
+	}
+	
+	if (critical_cb_count >= MAX_CRITICAL_CBS) 
+	{
+		LOG_ERR("Limite de callbacks de bateria crítica atingido");
+		return HAL_BATTERY_ERROR_STATE;
+	}
 	
-	LOG_DBG("Bateria: %d mV, %d%%, estado: %d", 
-	        voltage_mv, percentage, state);
+	critical_cbs[critical_cb_count++] = cb;
 	
 	return HAL_BATTERY_SUCCESS;
 }
@@ -401,7 +1562,22 @@ bool hal_battery_is_critical(void)
 	}
 	
 	hal_battery_info_t info;
+	
+#if defined(CONFIG_HAL_BATTERY_POF_WARNING)
+	// Evento do comparador ou último snapshot, sem acessar o ADC
+	if (atomic_get(&critical_latched)) 
+	{
+		return true;
+	}
+	
+	int ret = hal_battery_get_cached(&info, CONFIG_HAL_BATTERY_CACHE_MAX_AGE_MS);
+	if (ret == HAL_BATTERY_ERROR_STALE) 
+	{
+		ret = HAL_BATTERY_SUCCESS;
+	}
+#else
 	int ret = hal_battery_get_info(&info);
+#endif
 	
 	if (ret != HAL_BATTERY_SUCCESS) 
 	{
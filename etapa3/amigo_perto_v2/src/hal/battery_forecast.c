@@ -0,0 +1,238 @@
+/*
+ * HAL Battery Forecast - Estimativa de autonomia da bateria
+ * 
+ * @file battery_forecast.c
+ * @brief Implementação da estimativa de dias restantes até bateria crítica
+ * Localização: src/hal/battery_forecast.c
+ * Header público: include/hal/battery_forecast.h
+ * 
+ * Características:
+ * - Regressão linear sobre janela deslizante de CONFIG_HAL_BATTERY_FORECAST_WINDOW
+ *   amostras, espaçadas de CONFIG_HAL_BATTERY_FORECAST_INTERVAL_S
+ * - Somatórios Σy e Σx·y atualizados em O(1) a cada amostra
+ * - Inclinação e extrapolação em ponto fixo Q16 (int64)
+ * - Regressão sobre a tensão em repouso; o limiar crítico é deslocado pela
+ *   diferença atual entre repouso e tensão efetiva (queda sob carga e
+ *   compensação de temperatura), a mesma escala que decide o estado crítico
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "hal/battery_forecast.h"
+#include "hal/battery.h"
+
+// Zephyr includes
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+// Registra módulo de logging
+LOG_MODULE_REGISTER(hal_battery_forecast, LOG_LEVEL_DBG);
+
+/*******************************************************************************
+ * CONFIGURAÇÕES E CONSTANTES
+ ******************************************************************************/
+
+#define FORECAST_WINDOW         CONFIG_HAL_BATTERY_FORECAST_WINDOW
+#define FORECAST_INTERVAL_S     CONFIG_HAL_BATTERY_FORECAST_INTERVAL_S
+#define FORECAST_INTERVAL_MS    ((int64_t)FORECAST_INTERVAL_S * 1000)
+
+// Amostras mínimas para uma inclinação confiável
+#define FORECAST_MIN_SAMPLES    8
+
+// Limiar de HAL_BATTERY_STATE_CRITICAL (ver hal_battery_percentage_to_state)
+#define FORECAST_CRITICAL_PCT   10
+
+#define SECONDS_PER_DAY         86400
+#define Q16_SHIFT               16
+
+BUILD_ASSERT(FORECAST_WINDOW >= FORECAST_MIN_SAMPLES,
+             "Janela de regressão menor que o mínimo de amostras");
+
+/*******************************************************************************
+ * VARIÁVEIS PRIVADAS
+ ******************************************************************************/
+
+// Limiar de HAL_BATTERY_STATE_CRITICAL na tensão efetiva (ver hal_battery_info_t)
+static uint16_t critical_effective_mv = 0;
+
+// Janela deslizante de tensões em repouso (x = índice na janela, 0 = mais antiga)
+static uint16_t window[FORECAST_WINDOW];
+static uint16_t head = 0;             // Posição da amostra mais antiga (janela cheia)
+static uint16_t count = 0;            // Amostras na janela
+static int64_t sum_y = 0;             // Σ y
+static int64_t sum_xy = 0;            // Σ x·y
+
+// Última estimativa calculada (protegida por spinlock)
+static struct k_spinlock lock;
+static hal_battery_forecast_t forecast = {
+	.days_remaining = HAL_BATTERY_FORECAST_UNKNOWN,
+};
+
+// Instante da última amostra registrada
+static int64_t last_record_ms = 0;
+static bool has_recorded = false;
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS
+ ******************************************************************************/
+
+/**
+ * @brief Insere uma amostra na janela atualizando os somatórios em O(1)
+ * 
+ * Ao deslizar a janela cheia, todas as amostras restantes perdem uma
+ * unidade de x: Σx·y' = Σx·y - (Σy - y0) + (N-1)·y_novo.
+ * 
+ * @param voltage_mv Nova amostra de tensão
+ */
+static void window_push(uint16_t voltage_mv)
+{
+	if (count < FORECAST_WINDOW) 
+	{
+		sum_xy += (int64_t)count * voltage_mv;
+		sum_y += voltage_mv;
+		window[(head + count) % FORECAST_WINDOW] = voltage_mv;
+		count++;
+		return;
+	}
+	
+	uint16_t oldest = window[head];
+	
+	sum_xy = sum_xy - (sum_y - oldest) + (int64_t)(FORECAST_WINDOW - 1) * voltage_mv;
+	sum_y = sum_y - oldest + voltage_mv;
+	window[head] = voltage_mv;
+	head = (head + 1) % FORECAST_WINDOW;
+}
+
+/**
+ * @brief Recalcula a estimativa a partir dos somatórios da janela
+ * 
+ * Mínimos quadrados com x = 0..n-1:
+ *   inclinação = (n·Σxy - Σx·Σy) / (n·Σx² - (Σx)²)
+ * com Σx = n(n-1)/2 e denominador n²(n²-1)/12, ambos constantes para n.
+ * 
+ * @param result Estrutura onde a estimativa será armazenada
+ */
+static void forecast_compute(hal_battery_forecast_t *result)
+{
+	int64_t n = count;
+	
+	result->samples = count;
+	result->days_remaining = HAL_BATTERY_FORECAST_UNKNOWN;
+	result->slope_uv_per_day = 0;
+	result->fitted_mv = 0;
+	
+	if (n < FORECAST_MIN_SAMPLES) 
+	{
+		return;
+	}
+	
+	int64_t sum_x = n * (n - 1) / 2;
+	int64_t denom = n * n * (n * n - 1) / 12;
+	int64_t num = n * sum_xy - sum_x * sum_y;
+	
+	// Inclinação em mV por amostra (Q16)
+	int64_t slope_q16 = (num * (1 << Q16_SHIFT)) / denom;
+	
+	// Valor da reta na amostra mais recente (x = n-1), em mV (Q16)
+	int64_t fitted_q16 = (sum_y * (1 << Q16_SHIFT)) / n + slope_q16 * (n - 1) / 2;
+	
+	result->fitted_mv = (uint16_t)CLAMP(fitted_q16 >> Q16_SHIFT, 0, UINT16_MAX);
+	result->slope_uv_per_day = (int32_t)((slope_q16 * 1000 * SECONDS_PER_DAY /
+	                                      FORECAST_INTERVAL_S) >> Q16_SHIFT);
+	
+	if (slope_q16 >= 0) 
+	{
+		// Tensão estável ou subindo: sem previsão de esgotamento
+		return;
+	}
+	
+	int64_t margin_q16 = fitted_q16 - ((int64_t)result->critical_mv << Q16_SHIFT);
+	if (margin_q16 <= 0) 
+	{
+		result->days_remaining = 0;
+		return;
+	}
+	
+	// Amostras até o limiar × intervalo entre amostras
+	int64_t remaining_s = (margin_q16 * FORECAST_INTERVAL_S) / -slope_q16;
+	int64_t days = remaining_s / SECONDS_PER_DAY;
+	
+	result->days_remaining = (uint16_t)MIN(days, HAL_BATTERY_FORECAST_UNKNOWN - 1);
+}
+
+/**
+ * @brief Callback de amostragem periódica do HAL Battery
+ * 
+ * Alimenta a regressão apenas na cadência configurada.
+ */
+static void on_battery_sample(const hal_battery_info_t *info)
+{
+	int64_t now = k_uptime_get();
+	
+	if (has_recorded && (now - last_record_ms) < FORECAST_INTERVAL_MS) 
+	{
+		return;
+	}
+	
+	last_record_ms = now;
+	has_recorded = true;
+	
+	window_push(info->voltage_mv);
+	
+	// Limiar crítico levado à escala da tensão em repouso
+	int32_t offset_mv = (int32_t)info->voltage_mv - (int32_t)info->effective_mv;
+	
+	hal_battery_forecast_t result = {
+		.critical_mv = (uint16_t)CLAMP(critical_effective_mv + offset_mv, 0, UINT16_MAX),
+	};
+	forecast_compute(&result);
+	
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	forecast = result;
+	k_spin_unlock(&lock, key);
+	
+	LOG_DBG("Previsão: %d uV/dia, %u dias restantes (%u amostras)",
+	        result.slope_uv_per_day, result.days_remaining, result.samples);
+}
+
+/*******************************************************************************
+ * API PÚBLICA
+ ******************************************************************************/
+
+int hal_battery_forecast_init(void)
+{
+	critical_effective_mv = hal_battery_percentage_to_voltage(FORECAST_CRITICAL_PCT);
+	forecast.critical_mv = critical_effective_mv;
+	
+	int ret = hal_battery_register_sample_cb(on_battery_sample);
+	if (ret != HAL_BATTERY_SUCCESS) 
+	{
+		LOG_ERR("Falha ao registrar previsão na amostragem (err %d)", ret);
+		return ret;
+	}
+	
+	LOG_INF("Previsão de bateria: janela de %d amostras a cada %d s, limiar %u mV",
+	        FORECAST_WINDOW, FORECAST_INTERVAL_S, forecast.critical_mv);
+	
+	return HAL_BATTERY_SUCCESS;
+}
+
+int hal_battery_get_forecast(hal_battery_forecast_t *result)
+{
+	if (result == NULL) 
+	{
+		return HAL_BATTERY_ERROR_READ;
+	}
+	
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	*result = forecast;
+	k_spin_unlock(&lock, key);
+	
+	if (result->samples < FORECAST_MIN_SAMPLES) 
+	{
+		return HAL_BATTERY_ERROR_NO_DATA;
+	}
+	
+	return HAL_BATTERY_SUCCESS;
+}
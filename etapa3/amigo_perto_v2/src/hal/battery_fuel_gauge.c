@@ -0,0 +1,70 @@
+/*
+ * HAL Battery Fuel Gauge - Bateria como dispositivo fuel gauge do Zephyr
+ * 
+ * @file battery_fuel_gauge.c
+ * @brief Driver fuel_gauge para o nó "amigo,battery" do devicetree
+ * Localização: src/hal/battery_fuel_gauge.c
+ * 
+ * Características:
+ * - Instanciado pelo devicetree (DT_DRV_COMPAT amigo_battery)
+ * - Propriedades servidas a partir do snapshot em cache do HAL Battery:
+ *   fuel_gauge_get_prop() nunca dispara o ADC no contexto do chamador
+ * - Snapshot desatualizado agenda uma nova amostragem em segundo plano
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#define DT_DRV_COMPAT amigo_battery
+
+#include "hal/battery.h"
+
+// Zephyr includes
+#include <zephyr/device.h>
+#include <zephyr/drivers/fuel_gauge.h>
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS
+ ******************************************************************************/
+
+/**
+ * @brief Lê uma propriedade do fuel gauge a partir do snapshot em cache
+ */
+static int amigo_battery_get_prop(const struct device *dev, fuel_gauge_prop_t prop,
+                                  union fuel_gauge_prop_val *val)
+{
+	hal_battery_info_t info;
+	
+	ARG_UNUSED(dev);
+	
+	// Snapshot desatualizado ainda é servido: a nova amostragem já foi agendada
+	int ret = hal_battery_get_cached(&info, CONFIG_HAL_BATTERY_CACHE_MAX_AGE_MS);
+	if (ret != HAL_BATTERY_SUCCESS && ret != HAL_BATTERY_ERROR_STALE) 
+	{
+		return -ENODATA;
+	}
+	
+	switch (prop) {
+	case FUEL_GAUGE_VOLTAGE:
+		// API fuel_gauge: tensão em uV
+		val->voltage = (int)info.voltage_mv * 1000;
+		break;
+	
+	case FUEL_GAUGE_RELATIVE_STATE_OF_CHARGE:
+		val->relative_state_of_charge = info.percentage;
+		break;
+	
+	default:
+		return -ENOTSUP;
+	}
+	
+	return 0;
+}
+
+static DEVICE_API(fuel_gauge, amigo_battery_api) = {
+	.get_property = amigo_battery_get_prop,
+};
+
+// O HAL Battery é inicializado pela aplicação; o dispositivo não tem init
+DEVICE_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL,
+                      CONFIG_FUEL_GAUGE_INIT_PRIORITY, &amigo_battery_api);
@@ -0,0 +1,365 @@
+/*
+ * HAL Battery History - Histórico compactado de tensão da bateria
+ * 
+ * @file battery_history.c
+ * @brief Implementação do histórico de tensão da bateria
+ * Localização: src/hal/battery_history.c
+ * Header público: include/hal/battery_history.h
+ * 
+ * Características:
+ * - Ring buffer em RAM com 1 byte (delta) por amostra
+ * - Cadência fixa derivada das amostragens periódicas do HAL Battery
+ * - Persistência opcional em flash via subsistema settings, em blocos de
+ *   tamanho fixo (apenas os alterados desde a última gravação)
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "hal/battery_history.h"
+#include "hal/battery.h"
+
+// Zephyr includes
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#if defined(CONFIG_HAL_BATTERY_HISTORY_PERSIST)
+#include <zephyr/settings/settings.h>
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+// Registra módulo de logging
+LOG_MODULE_REGISTER(hal_battery_history, LOG_LEVEL_DBG);
+
+/*******************************************************************************
+ * CONFIGURAÇÕES E CONSTANTES
+ ******************************************************************************/
+
+#define HISTORY_SIZE            CONFIG_HAL_BATTERY_HISTORY_SIZE
+#define HISTORY_INTERVAL_MS     ((int64_t)CONFIG_HAL_BATTERY_HISTORY_INTERVAL_S * 1000)
+#define HISTORY_RESOLUTION_MV   CONFIG_HAL_BATTERY_HISTORY_RESOLUTION_MV
+
+// Delta máximo representável em um int8 (em unidades de resolução)
+#define HISTORY_DELTA_MAX       127
+
+#if defined(CONFIG_HAL_BATTERY_HISTORY_PERSIST)
+#define HISTORY_SETTINGS_ROOT   "bat_hist"
+#define HISTORY_SETTINGS_META   HISTORY_SETTINGS_ROOT "/meta"
+#define HISTORY_SETTINGS_RING   HISTORY_SETTINGS_ROOT "/ring"
+
+// O ring é gravado em blocos: um valor de settings de 4 KiB não cabe em um
+// item de NVS/ZMS com setores de 4 KiB
+#define HISTORY_CHUNK_SIZE      256
+#define HISTORY_CHUNKS          DIV_ROUND_UP(HISTORY_SIZE, HISTORY_CHUNK_SIZE)
+#define HISTORY_CHUNK_LEN(i)    MIN(HISTORY_CHUNK_SIZE, HISTORY_SIZE - (i) * HISTORY_CHUNK_SIZE)
+
+// "bat_hist/ring/" + índice do bloco
+#define HISTORY_CHUNK_NAME_LEN  (sizeof(HISTORY_SETTINGS_RING) + 4)
+#endif
+
+/*******************************************************************************
+ * VARIÁVEIS PRIVADAS
+ ******************************************************************************/
+
+/**
+ * @brief Metadados do ring (também é o formato persistido em flash)
+ */
+struct history_meta {
+	uint32_t total;                   /**< Total de amostras já registradas */
+	uint16_t head;                    /**< Próxima posição de escrita */
+	uint16_t count;                   /**< Amostras válidas no ring */
+	uint16_t oldest_mv;               /**< Valor absoluto da amostra mais antiga */
+	uint16_t newest_mv;               /**< Valor reconstruído da amostra mais recente */
+};
+
+// Ring buffer de deltas e metadados (protegidos por spinlock)
+static int8_t ring[HISTORY_SIZE];
+static struct history_meta meta;
+static struct k_spinlock lock;
+
+// Instante da última amostra registrada
+static int64_t last_record_ms = 0;
+static bool has_recorded = false;
+
+#if defined(CONFIG_HAL_BATTERY_HISTORY_PERSIST)
+// Amostras registradas desde a última persistência
+static uint16_t unsaved_samples = 0;
+
+// Blocos do ring alterados desde a última persistência
+static ATOMIC_DEFINE(dirty_chunks, HISTORY_CHUNKS);
+#endif
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - PERSISTÊNCIA
+ ******************************************************************************/
+
+#if defined(CONFIG_HAL_BATTERY_HISTORY_PERSIST)
+
+/**
+ * @brief Handler de restauração do settings
+ */
+static int history_settings_set(const char *name, size_t len,
+                                settings_read_cb read_cb, void *cb_arg)
+{
+	ssize_t ret;
+	
+	if (settings_name_steq(name, "meta", NULL)) 
+	{
+		struct history_meta stored;
+		
+		if (len != sizeof(stored)) 
+		{
+			return -EINVAL;
+		}
+		
+		ret = read_cb(cb_arg, &stored, sizeof(stored));
+		if (ret < 0) 
+		{
+			return ret;
+		}
+		
+		if (stored.head >= HISTORY_SIZE || stored.count > HISTORY_SIZE) 
+		{
+			LOG_WRN("Metadados de histórico incompatíveis, descartando");
+			return 0;
+		}
+		
+		meta = stored;
+		return 0;
+	}
+	
+	const char *next;
+	
+	if (settings_name_steq(name, "ring", &next) && next) 
+	{
+		unsigned long chunk = strtoul(next, NULL, 10);
+		
+		if (chunk >= HISTORY_CHUNKS || len != HISTORY_CHUNK_LEN(chunk)) 
+		{
+			return -EINVAL;
+		}
+		
+		ret = read_cb(cb_arg, &ring[chunk * HISTORY_CHUNK_SIZE], len);
+		return (ret < 0) ? ret : 0;
+	}
+	
+	return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(bat_hist, HISTORY_SETTINGS_ROOT, NULL,
+                               history_settings_set, NULL, NULL);
+
+/**
+ * @brief Persiste o histórico em flash
+ * 
+ * Grava os blocos do ring alterados desde a última persistência e, por
+ * último, os metadados.
+ */
+static void history_save(void)
+{
+	struct history_meta snapshot;
+	char name[HISTORY_CHUNK_NAME_LEN];
+	int err = 0;
+	
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	snapshot = meta;
+	k_spin_unlock(&lock, key);
+	
+	// O ring só é alterado pela work queue do sistema (mesmo contexto)
+	for (size_t i = 0; i < HISTORY_CHUNKS && !err; i++) 
+	{
+		if (!atomic_test_and_clear_bit(dirty_chunks, i)) 
+		{
+			continue;
+		}
+		
+		snprintf(name, sizeof(name), HISTORY_SETTINGS_RING "/%u", (unsigned int)i);
+		
+		err = settings_save_one(name, &ring[i * HISTORY_CHUNK_SIZE], HISTORY_CHUNK_LEN(i));
+		if (err) 
+		{
+			// Tenta novamente na próxima persistência
+			atomic_set_bit(dirty_chunks, i);
+		}
+	}
+	
+	if (!err) 
+	{
+		err = settings_save_one(HISTORY_SETTINGS_META, &snapshot, sizeof(snapshot));
+	}
+	
+	if (err) 
+	{
+		LOG_ERR("Falha ao persistir histórico (err %d)", err);
+	}
+}
+
+#endif /* CONFIG_HAL_BATTERY_HISTORY_PERSIST */
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - AMOSTRAGEM
+ ******************************************************************************/
+
+/**
+ * @brief Callback de amostragem periódica do HAL Battery
+ * 
+ * Registra no histórico apenas na cadência configurada.
+ */
+static void on_battery_sample(const hal_battery_info_t *info)
+{
+	int64_t now = k_uptime_get();
+	
+	if (has_recorded && (now - last_record_ms) < HISTORY_INTERVAL_MS) 
+	{
+		return;
+	}
+	
+	last_record_ms = now;
+	has_recorded = true;
+	
+	hal_battery_history_record(info->voltage_mv);
+}
+
+/*******************************************************************************
+ * API PÚBLICA
+ ******************************************************************************/
+
+int hal_battery_history_init(void)
+{
+#if defined(CONFIG_HAL_BATTERY_HISTORY_PERSIST)
+	int err = settings_subsys_init();
+	if (err) 
+	{
+		LOG_ERR("Falha ao inicializar settings (err %d)", err);
+	}
+	else 
+	{
+		settings_load_subtree(HISTORY_SETTINGS_ROOT);
+		LOG_INF("Histórico restaurado: %u amostras", meta.count);
+	}
+#endif
+
+	int ret = hal_battery_register_sample_cb(on_battery_sample);
+	if (ret != HAL_BATTERY_SUCCESS) 
+	{
+		LOG_ERR("Falha ao registrar histórico na amostragem (err %d)", ret);
+		return ret;
+	}
+	
+	LOG_INF("Histórico de bateria: %d amostras a cada %d s",
+	        HISTORY_SIZE, CONFIG_HAL_BATTERY_HISTORY_INTERVAL_S);
+	
+	return HAL_BATTERY_SUCCESS;
+}
+
+void hal_battery_history_record(uint16_t voltage_mv)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	
+	if (meta.count == 0) 
+	{
+		// Primeira amostra: referência absoluta
+		meta.oldest_mv = voltage_mv;
+		meta.newest_mv = voltage_mv;
+		ring[meta.head] = 0;
+	}
+	else 
+	{
+		// Delta em relação ao valor reconstruído (evita acúmulo de erro)
+		int32_t diff = (int32_t)voltage_mv - (int32_t)meta.newest_mv;
+		int32_t delta = (diff >= 0) ?
+		                (diff + HISTORY_RESOLUTION_MV / 2) / HISTORY_RESOLUTION_MV :
+		                (diff - HISTORY_RESOLUTION_MV / 2) / HISTORY_RESOLUTION_MV;
+		
+		delta = CLAMP(delta, -HISTORY_DELTA_MAX, HISTORY_DELTA_MAX);
+		
+		if (meta.count == HISTORY_SIZE) 
+		{
+			// Ring cheio: descarta a mais antiga (em head) e avança a referência
+			uint16_t next_oldest = (meta.head + 1) % HISTORY_SIZE;
+			
+			meta.oldest_mv += ring[next_oldest] * HISTORY_RESOLUTION_MV;
+			meta.count--;
+		}
+		
+		ring[meta.head] = (int8_t)delta;
+		meta.newest_mv += delta * HISTORY_RESOLUTION_MV;
+	}
+	
+#if defined(CONFIG_HAL_BATTERY_HISTORY_PERSIST)
+	atomic_set_bit(dirty_chunks, meta.head / HISTORY_CHUNK_SIZE);
+#endif
+	
+	meta.head = (meta.head + 1) % HISTORY_SIZE;
+	meta.count++;
+	meta.total++;
+	
+	k_spin_unlock(&lock, key);
+	
+	LOG_DBG("Histórico: %d mV registrado (%u amostras)", voltage_mv, meta.count);
+
+#if defined(CONFIG_HAL_BATTERY_HISTORY_PERSIST)
+	if (++unsaved_samples >= CONFIG_HAL_BATTERY_HISTORY_PERSIST_EVERY) 
+	{
+		unsaved_samples = 0;
+		history_save();
+	}
+#endif
+}
+
+int hal_battery_history_get_info(hal_battery_history_info_t *info)
+{
+	if (info == NULL) 
+	{
+		return HAL_BATTERY_ERROR_READ;
+	}
+	
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	
+	info->first_seq = meta.total - meta.count;
+	info->count = meta.count;
+	info->first_mv = meta.oldest_mv;
+	
+	k_spin_unlock(&lock, key);
+	
+	info->interval_s = CONFIG_HAL_BATTERY_HISTORY_INTERVAL_S;
+	info->resolution_mv = HISTORY_RESOLUTION_MV;
+	
+	return HAL_BATTERY_SUCCESS;
+}
+
+int hal_battery_history_read(uint32_t seq, int8_t *buf, size_t max_len)
+{
+	if (buf == NULL) 
+	{
+		return HAL_BATTERY_ERROR_READ;
+	}
+	
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	
+	uint32_t first_seq = meta.total - meta.count;
+	
+	if (seq < first_seq) 
+	{
+		k_spin_unlock(&lock, key);
+		return HAL_BATTERY_ERROR_NO_DATA;
+	}
+	
+	uint32_t available = meta.total - seq;
+	size_t n = MIN((size_t)available, max_len);
+	
+	// Posição física da amostra mais antiga no ring
+	uint16_t tail = (meta.head + HISTORY_SIZE - meta.count) % HISTORY_SIZE;
+	uint16_t pos = (tail + (seq - first_seq)) % HISTORY_SIZE;
+	
+	for (size_t i = 0; i < n; i++) 
+	{
+		buf[i] = ring[pos];
+		pos = (pos + 1) % HISTORY_SIZE;
+	}
+	
+	k_spin_unlock(&lock, key);
+	
+	return (int)n;
+}
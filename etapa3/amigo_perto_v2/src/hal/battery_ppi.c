@@ -0,0 +1,314 @@
+/*
+ * HAL Battery PPI - Aquisição da bateria disparada por hardware
+ * 
+ * @file battery_ppi.c
+ * @brief Backend RTC + PPI + SAADC (EasyDMA) do HAL Battery
+ * Localização: src/hal/battery_ppi.c
+ * Header interno: src/hal/battery_ppi.h
+ * 
+ * Características:
+ * - COMPARE0 do RTC2 dispara SAMPLE do SAADC e CLEAR do próprio RTC via
+ *   um canal (G)PPI com fork: nenhuma instrução da CPU por conversão
+ * - EasyDMA grava as amostras em buffer duplo (START_ON_END)
+ * - CPU acordada apenas a cada buffer completo ou no limite inferior
+ * - Calibração de offset do SAADC na inicialização
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "battery_ppi.h"
+
+// Zephyr includes
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/irq.h>
+
+// nrfx includes
+#include <nrfx_saadc.h>
+#include <nrfx_rtc.h>
+#include <helpers/nrfx_gppi.h>
+
+// Registra módulo de logging
+LOG_MODULE_REGISTER(hal_battery_ppi, LOG_LEVEL_DBG);
+
+/*******************************************************************************
+ * CONFIGURAÇÕES E CONSTANTES
+ ******************************************************************************/
+
+#define PPI_BUFFER_SAMPLES      CONFIG_HAL_BATTERY_PPI_BUFFER_SAMPLES
+
+// RTC2 a 8 Hz (tick de 125 ms): COMPARE0 cobre até ~24 dias com 24 bits
+#define RTC_FREQ_HZ             8
+#define RTC_COMPARE_CHANNEL     0
+
+// Canal do SAADC usado pelo backend
+#define SAADC_CHANNEL           0
+#define SAADC_NODE              DT_NODELABEL(adc)
+
+// Entrada do canal: a mesma do canal io-channels do modo ADC (VDD ou AINx).
+// No nRF52 os valores NRF_SAADC_* do devicetree coincidem com nrf_saadc_input_t.
+#if DT_NODE_HAS_PROP(DT_PATH(zephyr_user), io_channels)
+#define SAADC_CHANNEL_NODE      DT_CHILD_BY_UNIT_ADDR_INT(SAADC_NODE, \
+                                    DT_IO_CHANNELS_INPUT(DT_PATH(zephyr_user)))
+#define SAADC_INPUT             DT_PROP_OR(SAADC_CHANNEL_NODE, zephyr_input_positive, \
+                                           NRF_SAADC_INPUT_VDD)
+#else
+#define SAADC_INPUT             NRF_SAADC_INPUT_VDD
+#endif
+
+/*******************************************************************************
+ * VARIÁVEIS PRIVADAS
+ ******************************************************************************/
+
+static const nrfx_rtc_t rtc = NRFX_RTC_INSTANCE(2);
+
+// Buffer duplo preenchido por EasyDMA
+static int16_t buffers[2][PPI_BUFFER_SAMPLES];
+static uint8_t next_buffer = 0;
+
+// Média do último buffer completo (-1 = nenhum ainda)
+static atomic_t latest_avg = ATOMIC_INIT(-1);
+
+// Limite inferior configurado (para rearmar após o evento)
+static int16_t low_limit = NRFX_SAADC_LIMITL_DISABLED;
+
+static battery_ppi_cb_t on_done = NULL;
+static battery_ppi_cb_t on_limit = NULL;
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS
+ ******************************************************************************/
+
+/**
+ * @brief Handler de eventos do SAADC (contexto de interrupção)
+ */
+static void saadc_handler(nrfx_saadc_evt_t const *p_event)
+{
+	switch (p_event->type) {
+	case NRFX_SAADC_EVT_BUF_REQ:
+		// Próximo buffer, usado automaticamente no END (START_ON_END)
+		nrfx_saadc_buffer_set(buffers[next_buffer], PPI_BUFFER_SAMPLES);
+		next_buffer ^= 1;
+		break;
+	
+	case NRFX_SAADC_EVT_DONE: {
+		int32_t sum = 0;
+		uint16_t valid = 0;
+		
+		for (uint16_t i = 0; i < p_event->data.done.size; i++) 
+		{
+			int16_t raw = p_event->data.done.p_buffer[i];
+			
+			// Valida leitura (ignora valores negativos)
+			if (raw >= 0) 
+			{
+				sum += raw;
+				valid++;
+			}
+		}
+		
+		if (valid > 0) 
+		{
+			atomic_set(&latest_avg, sum / valid);
+			
+			if (on_done) 
+			{
+				on_done();
+			}
+		}
+		break;
+	}
+	
+	case NRFX_SAADC_EVT_LIMIT:
+		// Desarma o limite: VDD oscilando perto do limiar geraria uma
+		// interrupção por conversão
+		nrfx_saadc_limits_set(SAADC_CHANNEL, NRFX_SAADC_LIMITL_DISABLED,
+		                      NRFX_SAADC_LIMITH_DISABLED);
+		
+		if (on_limit) 
+		{
+			on_limit();
+		}
+		break;
+	
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Handler do RTC2 (interrupções não são habilitadas)
+ */
+static void rtc_handler(nrfx_rtc_int_type_t int_type)
+{
+	ARG_UNUSED(int_type);
+}
+
+/**
+ * @brief Configura o SAADC em modo avançado com disparo externo
+ */
+static int saadc_setup(int16_t low_limit_raw)
+{
+	nrfx_err_t err = nrfx_saadc_init(DT_IRQ(SAADC_NODE, priority));
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_ERR("Falha ao inicializar SAADC (err 0x%08x)", err);
+		return -EIO;
+	}
+	
+	// Calibração de offset bloqueante, antes do disparo por hardware
+	err = nrfx_saadc_offset_calibrate(NULL);
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_WRN("Calibração do SAADC falhou (err 0x%08x)", err);
+	}
+	
+	// Mesmos parâmetros do modo ADC: ganho 1/6, referência interna, 10 us.
+	// Em AINx o divisor resistivo tem impedância alta: aquisição de 40 us.
+	nrfx_saadc_channel_t channel = NRFX_SAADC_DEFAULT_CHANNEL_SE((nrf_saadc_input_t)SAADC_INPUT,
+	                                                             SAADC_CHANNEL);
+	channel.channel_config.gain = NRF_SAADC_GAIN1_6;
+	channel.channel_config.reference = NRF_SAADC_REFERENCE_INTERNAL;
+	channel.channel_config.acq_time = (SAADC_INPUT == NRF_SAADC_INPUT_VDD) ?
+	                                  NRF_SAADC_ACQTIME_10US : NRF_SAADC_ACQTIME_40US;
+	
+	err = nrfx_saadc_channel_config(&channel);
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_ERR("Falha ao configurar canal do SAADC (err 0x%08x)", err);
+		return -EIO;
+	}
+	
+	// Cada SAMPLE acumula 2^N conversões em burst; sem timer interno
+	nrfx_saadc_adv_config_t adv_config = NRFX_SAADC_DEFAULT_ADV_CONFIG;
+	adv_config.oversampling = (nrf_saadc_oversample_t)CONFIG_HAL_BATTERY_OVERSAMPLING;
+	adv_config.burst = NRF_SAADC_BURST_ENABLED;
+	adv_config.internal_timer_cc = 0;
+	adv_config.start_on_end = true;
+	
+	err = nrfx_saadc_advanced_mode_set(BIT(SAADC_CHANNEL), NRF_SAADC_RESOLUTION_12BIT,
+	                                   &adv_config, saadc_handler);
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_ERR("Falha ao configurar modo avançado do SAADC (err 0x%08x)", err);
+		return -EIO;
+	}
+	
+	nrfx_saadc_buffer_set(buffers[0], PPI_BUFFER_SAMPLES);
+	next_buffer = 1;
+	
+	err = nrfx_saadc_limits_set(SAADC_CHANNEL, low_limit_raw, NRFX_SAADC_LIMITH_DISABLED);
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_WRN("Falha ao configurar limite do SAADC (err 0x%08x)", err);
+	}
+	
+	// Arma o SAADC: as conversões passam a vir da tarefa SAMPLE via PPI
+	err = nrfx_saadc_mode_trigger();
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_ERR("Falha ao iniciar SAADC (err 0x%08x)", err);
+		return -EIO;
+	}
+	
+	return 0;
+}
+
+/**
+ * @brief Configura o RTC2 e o canal PPI COMPARE0 -> SAMPLE + CLEAR
+ */
+static int rtc_ppi_setup(uint32_t period_ms)
+{
+	nrfx_rtc_config_t rtc_config = NRFX_RTC_DEFAULT_CONFIG;
+	rtc_config.prescaler = RTC_FREQ_TO_PRESCALER(RTC_FREQ_HZ);
+	
+	nrfx_err_t err = nrfx_rtc_init(&rtc, &rtc_config, rtc_handler);
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_ERR("Falha ao inicializar RTC2 (err 0x%08x)", err);
+		return -EIO;
+	}
+	
+	uint32_t ticks = MAX(1U, (period_ms * RTC_FREQ_HZ) / 1000U);
+	
+	// Sem interrupção: o evento só roteia para o PPI
+	err = nrfx_rtc_cc_set(&rtc, RTC_COMPARE_CHANNEL, ticks, false);
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_ERR("Falha ao configurar COMPARE do RTC2 (err 0x%08x)", err);
+		return -EIO;
+	}
+	
+	uint8_t ppi_channel;
+	
+	if (nrfx_gppi_channel_alloc(&ppi_channel) != NRFX_SUCCESS) 
+	{
+		LOG_ERR("Nenhum canal PPI disponível");
+		return -EBUSY;
+	}
+	
+	nrfx_gppi_channel_endpoints_setup(ppi_channel,
+	                                  nrfx_rtc_event_address_get(&rtc, NRF_RTC_EVENT_COMPARE_0),
+	                                  nrf_saadc_task_address_get(NRF_SAADC, NRF_SAADC_TASK_SAMPLE));
+	
+	// O RTC do nRF52 não tem atalho COMPARE -> CLEAR: usa o fork do canal
+	nrfx_gppi_fork_endpoint_setup(ppi_channel,
+	                              nrfx_rtc_task_address_get(&rtc, NRF_RTC_TASK_CLEAR));
+	
+	nrfx_gppi_channels_enable(BIT(ppi_channel));
+	nrfx_rtc_enable(&rtc);
+	
+	LOG_INF("Amostragem por hardware: %u ticks RTC2 (%u ms), buffer de %d amostras",
+	        ticks, period_ms, PPI_BUFFER_SAMPLES);
+	
+	return 0;
+}
+
+/*******************************************************************************
+ * API INTERNA
+ ******************************************************************************/
+
+int battery_ppi_init(uint32_t period_ms, int16_t low_limit_raw,
+                     battery_ppi_cb_t done_cb, battery_ppi_cb_t limit_cb)
+{
+	on_done = done_cb;
+	on_limit = limit_cb;
+	low_limit = low_limit_raw;
+	
+	IRQ_CONNECT(DT_IRQN(SAADC_NODE), DT_IRQ(SAADC_NODE, priority),
+	            nrfx_isr, nrfx_saadc_irq_handler, 0);
+	IRQ_CONNECT(RTC2_IRQn, IRQ_PRIO_LOWEST,
+	            nrfx_isr, nrfx_rtc_2_irq_handler, 0);
+	
+	int ret = saadc_setup(low_limit_raw);
+	if (ret < 0) 
+	{
+		return ret;
+	}
+	
+	return rtc_ppi_setup(period_ms);
+}
+
+void battery_ppi_limit_rearm(void)
+{
+	nrfx_err_t err = nrfx_saadc_limits_set(SAADC_CHANNEL, low_limit, NRFX_SAADC_LIMITH_DISABLED);
+	if (err != NRFX_SUCCESS) 
+	{
+		LOG_WRN("Falha ao rearmar limite do SAADC (err 0x%08x)", err);
+	}
+}
+
+int battery_ppi_get_average(int16_t *avg_raw)
+{
+	atomic_val_t avg = atomic_get(&latest_avg);
+	
+	if (avg < 0) 
+	{
+		return -ENODATA;
+	}
+	
+	*avg_raw = (int16_t)avg;
+	
+	return 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * HAL Battery PPI - Aquisição da bateria disparada por hardware
+ * 
+ * @file battery_ppi.h
+ * @brief Interface interna do backend RTC + PPI + SAADC do HAL Battery
+ * Localização: src/hal/battery_ppi.h
+ * 
+ * Uso exclusivo de src/hal/battery.c quando
+ * CONFIG_HAL_BATTERY_SAMPLING_PPI está habilitado.
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef HAL_BATTERY_PPI_H_
+#define HAL_BATTERY_PPI_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Callback de evento do backend (contexto de interrupção)
+ */
+typedef void (*battery_ppi_cb_t)(void);
+
+/**
+ * @brief Inicia a aquisição periódica por hardware
+ * 
+ * O RTC2 dispara a tarefa SAMPLE do SAADC via (G)PPI a cada period_ms; o
+ * resultado é gravado por EasyDMA em um buffer duplo. A CPU só é acordada
+ * quando um buffer enche (done_cb) ou quando uma amostra fica abaixo de
+ * low_limit_raw (limit_cb, disparado uma única vez).
+ * 
+ * @param period_ms Intervalo entre conversões (ms)
+ * @param low_limit_raw Limite inferior em valor raw do SAADC
+ * @param done_cb Chamado a cada buffer completo
+ * @param limit_cb Chamado quando o limite inferior é ultrapassado
+ * 
+ * @return 0 em sucesso, < 0 em erro
+ */
+int battery_ppi_init(uint32_t period_ms, int16_t low_limit_raw,
+                     battery_ppi_cb_t done_cb, battery_ppi_cb_t limit_cb);
+
+/**
+ * @brief Rearma o limite inferior após o evento de limit_cb
+ */
+void battery_ppi_limit_rearm(void);
+
+/**
+ * @brief Obtém a média raw do último buffer completo
+ * 
+ * @param avg_raw Ponteiro para armazenar o valor raw médio
+ * 
+ * @return 0 em sucesso, -ENODATA se nenhum buffer foi completado ainda
+ */
+int battery_ppi_get_average(int16_t *avg_raw);
+
+#endif /* HAL_BATTERY_PPI_H_ */
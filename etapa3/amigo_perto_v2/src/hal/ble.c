@@ -11,9 +11,29 @@
  * 
  * Funcionalidades:
  * - Inicialização e configuração do stack BLE
- * - Controle de advertising (start/stop, parâmetros customizados)
- * - Gerenciamento de conexões (callbacks de eventos)
- * - Atualização de parâmetros de conexão
+ * - Controle de advertising (start/stop, parâmetros customizados) com
+ *   cronograma de estágios trocados por work item
+ * - Gerenciamento de até CONFIG_BT_MAX_CONN conexões simultâneas (celulares
+ *   da família), com tabela de contexto por conexão e advertising mantido
+ *   enquanto houver vaga
+ * - Negociação de parâmetros de conexão por perfil (IDLE/ALERT), após a
+ *   acomodação da descoberta de serviços e com retentativa
+ * - Amostragem periódica do RSSI da conexão principal (HCI Read RSSI) em
+ *   uma fila lock-free de produtor e consumidor únicos
+ * - Monitoramento de perda de percurso pelo controlador (LE Power
+ *   Control), com a amostragem de RSSI como alternativa sem suporte
+ * - Gerenciador de PHY: 2M enquanto houver transferência em massa, LE
+ *   Coded quando a conexão principal se aproxima da borda do dome, e
+ *   contabilidade do tempo em cada PHY
+ * - Advertising estendido no LE Coded (build de longo alcance)
+ * - Estado da coleira nos dados de fabricante do advertising, trocado
+ *   sem parar o advertising
+ * - Trem de advertising periódico com o estado da coleira, para
+ *   observadores sincronizados
+ * - Beacon não conectável concorrente ao advertising de conexão, cada
+ *   conjunto com o próprio intervalo e potência de transmissão
+ * - Controle adaptativo da potência de transmissão de cada conexão pela
+ *   perda de percurso, com piso durante o alarme
  * - Encapsulamento das APIs Zephyr para facilitar uso
  * 
  * Copyright (c) 2025
@@ -25,6 +45,7 @@
 // Zephyr includes
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 
 // Bluetooth includes
 #include <zephyr/bluetooth/bluetooth.h>
@@ -33,6 +54,7 @@
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gap.h>
 #include <zephyr/bluetooth/hci.h>
+#include <zephyr/bluetooth/hci_vs.h>
 
 // Serviço GATT customizado
 #include "gatt/buzzer_service.h"
@@ -55,9 +77,112 @@ LOG_MODULE_REGISTER(hal_ble, LOG_LEVEL_DBG);
 // Tamanho máximo do nome do dispositivo
 #define MAX_DEVICE_NAME_LEN             29
 
+// Dados de um PDU de advertising legado e cabeçalho de cada campo AD
+// (tamanho + tipo): o nome que não cabe é anunciado abreviado
+#define ADV_LEGACY_DATA_LEN             31
+#define AD_FIELD_HDR_LEN                2
+
+// Intervalo mínimo da amostragem de RSSI
+#define RSSI_INTERVAL_MIN_MS            100
+
+// Fila de amostras de RSSI (índices mascarados: tamanho potência de 2)
+#define RSSI_RING_SIZE                  CONFIG_HAL_BLE_RSSI_RING_SIZE
+#define RSSI_RING_MASK                  (RSSI_RING_SIZE - 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(RSSI_RING_SIZE),
+             "CONFIG_HAL_BLE_RSSI_RING_SIZE deve ser potência de 2");
+BUILD_ASSERT(CONFIG_HAL_BLE_RSSI_INTERVAL_MS == 0 ||
+             CONFIG_HAL_BLE_RSSI_INTERVAL_MS >= RSSI_INTERVAL_MIN_MS,
+             "CONFIG_HAL_BLE_RSSI_INTERVAL_MS abaixo do mínimo");
+
+// Callbacks notificados a cada amostra de RSSI
+#define MAX_RSSI_CBS                    2
+
+// Conexões simultâneas (uma entrada da tabela de contexto por conexão)
+#define MAX_CONN                        CONFIG_BT_MAX_CONN
+
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+// Amostras consecutivas abaixo do limiar antes de passar ao LE Coded
+#define PHY_EDGE_SAMPLES                3
+
+// Margem acima do limiar para deixar o LE Coded
+#define PHY_RSSI_HYSTERESIS_DB          6
+
+// Codificação usada no LE Coded
+#if defined(CONFIG_HAL_BLE_PHY_CODED_S8)
+#define PHY_CODED_OPT                   BT_CONN_LE_PHY_OPT_CODED_S8
+#else
+#define PHY_CODED_OPT                   BT_CONN_LE_PHY_OPT_CODED_S2
+#endif
+#endif /* CONFIG_HAL_BLE_PHY_MANAGER */
+
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+// Advertising periódico: SID do conjunto (o advertising conectável usa 0)
+#define PER_ADV_SID                     1
+
+// Intervalo do advertising estendido que leva a sync info do trem
+#define PER_ADV_EXT_INTERVAL_MS         1000
+
+// Limites do intervalo periódico (unidades de 1.25 ms, 6 a 65535)
+#define PER_ADV_INTERVAL_MIN_MS         8
+#define PER_ADV_INTERVAL_MAX_MS         81910
+#endif /* CONFIG_HAL_BLE_PERIODIC_ADV */
+
+#if defined(CONFIG_HAL_BLE_BEACON)
+// Beacon: SID do conjunto (PDUs legados, informado só por consistência)
+#define BEACON_SID                      2
+#endif
+
+// Limites da potência de transmissão pedida ao controlador (nRF52840)
+#define TX_POWER_MIN_DBM                -40
+#define TX_POWER_MAX_DBM                8
+
+// Potência ainda não aplicada (vale a padrão do controlador)
+#define TX_POWER_UNKNOWN                INT8_MIN
+
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+// Redução por passo e margem para reduzir (dB)
+#define TXP_STEP_DB                     4
+
+// Amostras consecutivas pedindo menos potência antes de reduzir
+#define TXP_DOWN_SAMPLES                3
+
+// Limites do controle (o piso do alarme não passa do teto)
+#define TXP_MAX_DBM                     CONFIG_HAL_BLE_TX_POWER_MAX_DBM
+#define TXP_MIN_DBM                     MIN(CONFIG_HAL_BLE_TX_POWER_MIN_DBM, TXP_MAX_DBM)
+#define TXP_ALARM_FLOOR_DBM             MIN(CONFIG_HAL_BLE_TX_POWER_ALARM_FLOOR_DBM, TXP_MAX_DBM)
+
+BUILD_ASSERT(CONFIG_HAL_BLE_TX_POWER_MIN_DBM <= CONFIG_HAL_BLE_TX_POWER_MAX_DBM,
+             "CONFIG_HAL_BLE_TX_POWER_MIN_DBM acima do máximo");
+#endif /* CONFIG_HAL_BLE_TX_POWER_CONTROL */
+
+// Flags do estado anunciado nos dados de fabricante
+#define ADV_STATUS_FLAG_ALARM           BIT(0)
+
 // Conversão de milissegundos para unidades BLE (0.625ms por unidade)
 #define MS_TO_BLE_UNITS(ms)             ((ms) * 8 / 5)
 
+// Conversão de milissegundos para unidades de intervalo de conexão (1.25ms)
+#define MS_TO_CONN_UNITS(ms)            ((ms) * 4 / 5)
+
+// Conversão de milissegundos para unidades de timeout de supervisão (10ms)
+#define MS_TO_TIMEOUT_UNITS(ms)         ((ms) / 10)
+
+// Parâmetros de cada perfil de conexão, dentro das regras aceitas pelos
+// centrais iOS/Android: intervalo_max * (latência + 1) <= 2 s e timeout
+// maior que 3 * intervalo_max * (latência + 1)
+static const struct bt_le_conn_param conn_profiles[] = {
+	// IDLE: 400-500 ms, 2 eventos pulados -> rádio acorda a cada ~1,5 s
+	[HAL_BLE_CONN_PROFILE_IDLE] = BT_LE_CONN_PARAM_INIT(MS_TO_CONN_UNITS(400),
+	                                                    MS_TO_CONN_UNITS(500), 2,
+	                                                    MS_TO_TIMEOUT_UNITS(6000)),
+	// ALERT: 15-30 ms sem latência -> escrita do buzzer atendida em ~30 ms;
+	// timeout curto -> perda de enlace detectada cedo (Link Loss Service)
+	[HAL_BLE_CONN_PROFILE_ALERT] = BT_LE_CONN_PARAM_INIT(MS_TO_CONN_UNITS(15),
+	                                                     MS_TO_CONN_UNITS(30), 0,
+	                                                     MS_TO_TIMEOUT_UNITS(CONFIG_HAL_BLE_ALERT_SUPERVISION_TIMEOUT_MS)),
+};
+
 /*******************************************************************************
  * VARIÁVEIS PRIVADAS
  ******************************************************************************/
@@ -70,262 +195,2699 @@ static hal_ble_callbacks_t user_callbacks = {0};
 // Nome do dispositivo
 static char device_name[MAX_DEVICE_NAME_LEN + 1] = {0};
 
-// Conexão atual
-static struct bt_conn *current_conn = NULL;
+// Contexto de cada conexão. A conexão principal (a mais antiga) é a que
+// acompanha o dome: recebe o perfil solicitado pela aplicação e tem o
+// enlace monitorado. As demais ficam no perfil IDLE, de modo que no máximo
+// uma conexão usa o intervalo curto do ALERT e o rádio não multiplica o
+// consumo a cada celular conectado.
+struct ble_conn_ctx {
+	struct bt_conn *conn;               // Referência da conexão (NULL se livre)
+	uint8_t id;                         // Índice na tabela
+	bool primary;                       // Conexão principal
+	uint16_t interval;                  // Intervalo concedido (unidades de 1.25ms)
+	uint16_t latency;                   // Latência concedida (eventos)
+	uint16_t timeout;                   // Timeout concedido (unidades de 10ms)
+	uint8_t param_retries;              // Tentativas de negociação restantes
+	bool settled;                       // Descoberta de serviços já acomodada
+	struct k_work_delayable param_work; // Acomodação, negociação e retentativa
+	struct k_work_delayable rssi_work;  // Amostragem periódica de RSSI
+	struct k_work monitor_work;         // Escolha entre perda de percurso e RSSI
+	bool path_loss_active;              // Perda de percurso monitorada pelo controlador
+	hal_ble_phy_t phy;                  // PHY atual (transmissão)
+	int64_t phy_since_ms;               // Início do trecho no PHY atual
+	bool phy_edge;                      // Borda do dome: pede o LE Coded
+	uint8_t phy_edge_count;             // Amostras consecutivas abaixo do limiar
+	struct k_work phy_work;             // Aplica a política de PHY
+	int8_t tx_power;                    // Potência aplicada (dBm, TX_POWER_UNKNOWN)
+	int8_t tx_power_req;                // Potência pedida pelo controle (dBm)
+	uint8_t tx_down_count;              // Amostras consecutivas pedindo menos potência
+	struct k_work_delayable txp_work;   // Controle adaptativo da potência
+};
+
+static struct ble_conn_ctx conn_ctx[MAX_CONN];
+static uint8_t conn_count = 0;
+
+// Perfil de parâmetros de conexão solicitado pela aplicação
+static hal_ble_conn_profile_t conn_profile = HAL_BLE_CONN_PROFILE_IDLE;
+
+// Intervalo da amostragem de RSSI (0 = desativada)
+static uint32_t rssi_interval_ms = CONFIG_HAL_BLE_RSSI_INTERVAL_MS;
+
+// Fila de amostras de RSSI: produtor único (rssi_work) e consumidor único
+// (hal_ble_rssi_pop()). Os índices crescem livremente e só são mascarados
+// no acesso; cada lado escreve apenas o próprio índice.
+static hal_ble_rssi_sample_t rssi_ring[RSSI_RING_SIZE];
+static atomic_t rssi_head = ATOMIC_INIT(0);  // Próxima escrita (produtor)
+static atomic_t rssi_tail = ATOMIC_INIT(0);  // Próxima leitura (consumidor)
+
+// Última amostra da conexão principal, lida por qualquer contexto
+static struct k_spinlock rssi_lock;
+static hal_ble_rssi_sample_t rssi_latest;
+static bool rssi_valid = false;
+
+static hal_ble_rssi_cb_t rssi_cbs[MAX_RSSI_CBS];
+static uint8_t rssi_cb_count = 0;
+
+// Monitoramento de perda de percurso solicitado (cb NULL = desativado)
+static hal_ble_path_loss_params_t path_loss_params;
+static hal_ble_path_loss_cb_t path_loss_cb = NULL;
+
+// Transferências em massa pendentes (pedem o PHY 2M)
+static atomic_t bulk_pending = ATOMIC_INIT(0);
+
+// Tempo acumulado em cada PHY pelas conexões já encerradas ou pelos
+// trechos concluídos (atualizado na thread RX e lido por qualquer contexto)
+static struct k_spinlock phy_lock;
+static hal_ble_phy_stats_t phy_stats;
 
 // Work item para iniciar advertising de forma assíncrona
 static struct k_work adv_work;
 
+// Registro de estado nos dados de fabricante (formato em hal_ble_adv_status_t)
+struct adv_status_record {
+	uint16_t company_id;                // Company ID (little-endian)
+	uint8_t profile_id;                 // Perfil do firmware
+	uint8_t seq;                        // Sequência: muda a cada alteração
+	uint8_t battery_pct;                // Bateria (%)
+	uint8_t flags;                      // ADV_STATUS_FLAG_*
+} __packed;
+
+// Estado informado pela aplicação (qualquer contexto, protegido por lock)
+static struct k_spinlock adv_status_lock;
+static struct adv_status_record adv_status = {
+	.company_id = sys_cpu_to_le16(CONFIG_HAL_BLE_STATUS_COMPANY_ID),
+	.profile_id = CONFIG_HAL_BLE_STATUS_PROFILE_ID,
+	.battery_pct = HAL_BLE_BATTERY_UNKNOWN,
+};
+
+// Cópia apontada pelos dados de advertising: escrita só na work queue do
+// sistema, onde o advertising é iniciado e atualizado
+static struct adv_status_record adv_status_data;
+
+// Work item para trocar os dados de fabricante do advertising em andamento
+static struct k_work adv_update_work;
+
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+// Conjunto de advertising estendido do trem periódico, criado na primeira
+// ativação e manipulado só na work queue do sistema
+static struct bt_le_ext_adv *per_adv = NULL;
+static bool per_adv_running = false;
+
+// Estado do trem solicitado pela aplicação
+static bool per_adv_enable = false;
+static uint32_t per_adv_interval_ms = CONFIG_HAL_BLE_PERIODIC_ADV_INTERVAL_MS;
+
+// Dados do trem (estado da coleira) e do advertising estendido (nome)
+static struct bt_data per_ad_data[1];
+static struct bt_data per_ext_ad_data[1];
+static size_t per_ext_ad_data_count = 0;
+
+// Work item que aplica o estado solicitado do trem
+static struct k_work per_adv_work;
+#endif /* CONFIG_HAL_BLE_PERIODIC_ADV */
+
+#if defined(CONFIG_HAL_BLE_BEACON)
+// Conjunto do beacon não conectável, criado na primeira ativação e
+// manipulado só na work queue do sistema
+static struct bt_le_ext_adv *beacon_adv = NULL;
+static bool beacon_running = false;
+
+// Estado do beacon solicitado pela aplicação
+static bool beacon_enable = false;
+static hal_ble_beacon_params_t beacon_params = {
+	.interval_ms = CONFIG_HAL_BLE_BEACON_INTERVAL_MS,
+	.tx_power_dbm = CONFIG_HAL_BLE_BEACON_TX_POWER_DBM,
+};
+
+// Potência anunciada no TX Power Level (a escolhida pelo controlador)
+static int8_t beacon_tx_power_ad = CONFIG_HAL_BLE_BEACON_TX_POWER_DBM;
+
+// Dados do beacon: flags, nome, TX Power Level e estado da coleira
+static struct bt_data beacon_ad_data[4];
+static size_t beacon_ad_data_count = 0;
+
+// Work item que aplica o estado solicitado do beacon
+static struct k_work beacon_work;
+#endif /* CONFIG_HAL_BLE_BEACON */
+
+// Conjunto do advertising de conexão (advertising estendido habilitado;
+// sem ele, a API legada é usada)
+static struct bt_le_ext_adv *conn_adv = NULL;
+
+// Potência de transmissão do advertising de conexão (dBm)
+static int8_t conn_adv_tx_power = CONFIG_HAL_BLE_ADV_TX_POWER_DBM;
+
+// Work item que aplica a potência dos conjuntos em andamento
+static struct k_work adv_tx_work;
+
+// Alarme tocando (informado em hal_ble_set_adv_status()): piso de potência
+static bool alarm_active = false;
+
 // Dados de advertising
-static struct bt_data ad_data[2];
+static struct bt_data ad_data[4];
 static struct bt_data sd_data[1];
 static size_t ad_data_count = 0;
 static size_t sd_data_count = 0;
 
 // Parâmetros de advertising
 static struct bt_le_adv_param adv_param_storage;
-static const struct bt_le_adv_param *adv_param = NULL;
+static uint32_t adv_options = BT_LE_ADV_OPT_CONN | BT_LE_ADV_OPT_USE_IDENTITY;
+
+// Cronograma de advertising (padrão: estágio único com intervalo fixo)
+static hal_ble_adv_stage_t adv_schedule[HAL_BLE_ADV_MAX_STAGES] = {
+	{
+		.interval_min_ms = DEFAULT_ADV_INTERVAL_MIN_MS,
+		.interval_max_ms = DEFAULT_ADV_INTERVAL_MAX_MS,
+		.duration_s = 0,
+	},
+};
+static uint8_t adv_stage_count = 1;
+static uint8_t adv_stage = 0;
+
+// Work item para trocar de estágio do cronograma
+static struct k_work_delayable adv_stage_work;
+
+// Work item para voltar ao primeiro estágio após a última desconexão
+static struct k_work adv_restart_work;
 
 /*******************************************************************************
- * FUNÇÕES PRIVADAS - CALLBACKS DO STACK BLUETOOTH
+ * FUNÇÕES PRIVADAS - TABELA DE CONEXÕES
+ ******************************************************************************/
+
+/**
+ * @brief Busca o contexto de uma conexão
+ * 
+ * @return Contexto ou NULL se a conexão não está na tabela
+ */
+static struct ble_conn_ctx *conn_ctx_find(const struct bt_conn *conn)
+{
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		if (conn_ctx[i].conn && conn_ctx[i].conn == conn) 
+		{
+			return &conn_ctx[i];
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * @brief Busca uma entrada livre da tabela
+ * 
+ * @return Contexto livre ou NULL se a tabela está cheia
+ */
+static struct ble_conn_ctx *conn_ctx_alloc(void)
+{
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		if (!conn_ctx[i].conn) 
+		{
+			return &conn_ctx[i];
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * @brief Retorna o contexto da conexão principal
+ * 
+ * @return Contexto ou NULL se não há conexão
+ */
+static struct ble_conn_ctx *conn_ctx_primary(void)
+{
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		if (conn_ctx[i].conn && conn_ctx[i].primary) 
+		{
+			return &conn_ctx[i];
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * @brief Retorna a primeira conexão ativa da tabela
+ * 
+ * @return Contexto ou NULL se não há conexão
+ */
+static struct ble_conn_ctx *conn_ctx_first(void)
+{
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		if (conn_ctx[i].conn) 
+		{
+			return &conn_ctx[i];
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * @brief Perfil de parâmetros aplicado a uma conexão
+ * 
+ * Só a conexão principal segue o perfil da aplicação.
+ */
+static hal_ble_conn_profile_t conn_ctx_profile(const struct ble_conn_ctx *ctx)
+{
+	return ctx->primary ? conn_profile : HAL_BLE_CONN_PROFILE_IDLE;
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - PARÂMETROS DE CONEXÃO
+ ******************************************************************************/
+
+/**
+ * @brief Preenche as informações públicas a partir do contexto da conexão
+ */
+static void conn_info_fill(const struct ble_conn_ctx *ctx, hal_ble_conn_info_t *conn_info)
+{
+	conn_info->interval_ms = ctx->interval * 1250 / 1000; // 1.25ms por unidade
+	conn_info->latency = ctx->latency;
+	conn_info->timeout_ms = ctx->timeout * 10; // 10ms por unidade
+	conn_info->profile = conn_ctx_profile(ctx);
+	conn_info->conn_id = ctx->id;
+	conn_info->primary = ctx->primary;
+	conn_info->phy = ctx->phy;
+}
+
+/**
+ * @brief Verifica se os parâmetros concedidos atendem ao perfil
+ * 
+ * O timeout de supervisão fica a critério do central, exceto no perfil
+ * ALERT: um timeout maior atrasaria a detecção da perda de enlace.
+ */
+static bool conn_params_match(const struct ble_conn_ctx *ctx, hal_ble_conn_profile_t profile)
+{
+	const struct bt_le_conn_param *param = &conn_profiles[profile];
+	
+	if (profile == HAL_BLE_CONN_PROFILE_ALERT && ctx->timeout > param->timeout) 
+	{
+		return false;
+	}
+	
+	return ctx->interval >= param->interval_min &&
+	       ctx->interval <= param->interval_max &&
+	       ctx->latency == param->latency;
+}
+
+/**
+ * @brief Handler da negociação de parâmetros de conexão
+ * 
+ * Executado após a acomodação da descoberta de serviços e, enquanto o
+ * central não conceder o perfil, a cada CONFIG_HAL_BLE_CONN_PARAM_RETRY_MS.
+ */
+static void conn_param_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct ble_conn_ctx *ctx = CONTAINER_OF(dwork, struct ble_conn_ctx, param_work);
+	
+	if (!ctx->conn) 
+	{
+		return;
+	}
+	
+	ctx->settled = true;
+	
+	hal_ble_conn_profile_t profile = conn_ctx_profile(ctx);
+	
+	if (conn_params_match(ctx, profile)) 
+	{
+		LOG_DBG("Conexão %u: parâmetros já atendem ao perfil %d", ctx->id, profile);
+		return;
+	}
+	
+	if (ctx->param_retries == 0) 
+	{
+		LOG_WRN("Conexão %u: central não concedeu o perfil %d (intervalo %u, latência %u)",
+		        ctx->id, profile, ctx->interval, ctx->latency);
+		return;
+	}
+	
+	ctx->param_retries--;
+	
+	const struct bt_le_conn_param *param = &conn_profiles[profile];
+	int err = bt_conn_le_param_update(ctx->conn, param);
+	if (err) 
+	{
+		LOG_WRN("Falha ao solicitar parâmetros de conexão (err %d)", err);
+	}
+	else 
+	{
+		LOG_INF("Conexão %u: solicitando perfil %d - Intervalo: %u-%u, Latência: %u, Timeout: %u",
+		        ctx->id, profile, param->interval_min, param->interval_max, param->latency,
+		        param->timeout);
+	}
+	
+	// O central pode recusar sem aviso: confere (e repete) mais tarde
+	k_work_schedule(&ctx->param_work, K_MSEC(CONFIG_HAL_BLE_CONN_PARAM_RETRY_MS));
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - PHY
+ ******************************************************************************/
+
+/**
+ * @brief Converte o PHY informado pelo stack
+ */
+static hal_ble_phy_t phy_from_gap(uint8_t gap_phy)
+{
+	switch (gap_phy) {
+	case BT_GAP_LE_PHY_2M:
+		return HAL_BLE_PHY_2M;
+	case BT_GAP_LE_PHY_CODED:
+		return HAL_BLE_PHY_CODED;
+	default:
+		return HAL_BLE_PHY_1M;
+	}
+}
+
+/**
+ * @brief Fecha o trecho em andamento no PHY atual da conexão
+ * 
+ * @return Duração do trecho (ms)
+ */
+static uint32_t phy_account(struct ble_conn_ctx *ctx)
+{
+	int64_t now = k_uptime_get();
+	uint32_t duration_ms = (uint32_t)(now - ctx->phy_since_ms);
+	
+	k_spinlock_key_t key = k_spin_lock(&phy_lock);
+	phy_stats.time_ms[ctx->phy] += duration_ms;
+	k_spin_unlock(&phy_lock, key);
+	
+	ctx->phy_since_ms = now;
+	
+	return duration_ms;
+}
+
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+
+/**
+ * @brief PHY desejado para a conexão
+ * 
+ * Na borda do dome o alcance tem prioridade (LE Coded); senão, uma
+ * transferência em massa pede o 2M. O build de longo alcance permanece
+ * no LE Coded no restante do tempo.
+ */
+static hal_ble_phy_t phy_desired(const struct ble_conn_ctx *ctx)
+{
+	if (ctx->phy_edge) 
+	{
+		return HAL_BLE_PHY_CODED;
+	}
+	
+	if (atomic_get(&bulk_pending) > 0) 
+	{
+		return HAL_BLE_PHY_2M;
+	}
+	
+	return IS_ENABLED(CONFIG_HAL_BLE_LONG_RANGE) ? HAL_BLE_PHY_CODED : HAL_BLE_PHY_1M;
+}
+
+/**
+ * @brief Handler que solicita ao central o PHY desejado
+ * 
+ * O resultado chega por on_le_phy_updated(); se o central recusar, o PHY
+ * atual é mantido até a próxima mudança de política.
+ */
+static void phy_work_handler(struct k_work *work)
+{
+	struct ble_conn_ctx *ctx = CONTAINER_OF(work, struct ble_conn_ctx, phy_work);
+	
+	if (!ctx->conn) 
+	{
+		return;
+	}
+	
+	hal_ble_phy_t phy = phy_desired(ctx);
+	
+	if (phy == ctx->phy) 
+	{
+		return;
+	}
+	
+	static const uint8_t gap_phy[HAL_BLE_PHY_COUNT] = {
+		[HAL_BLE_PHY_1M] = BT_GAP_LE_PHY_1M,
+		[HAL_BLE_PHY_2M] = BT_GAP_LE_PHY_2M,
+		[HAL_BLE_PHY_CODED] = BT_GAP_LE_PHY_CODED,
+	};
+	
+	const struct bt_conn_le_phy_param param = {
+		.options = (phy == HAL_BLE_PHY_CODED) ? PHY_CODED_OPT : BT_CONN_LE_PHY_OPT_NONE,
+		.pref_tx_phy = gap_phy[phy],
+		.pref_rx_phy = gap_phy[phy],
+	};
+	
+	int err = bt_conn_le_phy_update(ctx->conn, &param);
+	if (err) 
+	{
+		LOG_WRN("Conexão %u: falha ao solicitar PHY %d (err %d)", ctx->id, phy, err);
+	}
+	else 
+	{
+		LOG_DBG("Conexão %u: solicitando PHY %d", ctx->id, phy);
+	}
+}
+
+/**
+ * @brief Marca a conexão dentro ou fora da borda do dome
+ */
+static void phy_edge_set(struct ble_conn_ctx *ctx, bool edge)
+{
+	if (ctx->phy_edge == edge) 
+	{
+		return;
+	}
+	
+	ctx->phy_edge = edge;
+	
+	LOG_INF("Conexão %u %s da borda do dome", ctx->id, edge ? "perto" : "longe");
+	
+	k_work_submit(&ctx->phy_work);
+}
+
+/**
+ * @brief Avalia a borda do dome por uma amostra de RSSI
+ */
+static void phy_rssi_evaluate(struct ble_conn_ctx *ctx, int8_t rssi)
+{
+	if (rssi < CONFIG_HAL_BLE_PHY_CODED_RSSI_DBM) 
+	{
+		if (ctx->phy_edge_count < PHY_EDGE_SAMPLES) 
+		{
+			ctx->phy_edge_count++;
+		}
+		
+		if (ctx->phy_edge_count >= PHY_EDGE_SAMPLES) 
+		{
+			phy_edge_set(ctx, true);
+		}
+		return;
+	}
+	
+	ctx->phy_edge_count = 0;
+	
+	if (rssi > CONFIG_HAL_BLE_PHY_CODED_RSSI_DBM + PHY_RSSI_HYSTERESIS_DB) 
+	{
+		phy_edge_set(ctx, false);
+	}
+}
+
+/**
+ * @brief Reaplica a política de PHY em todas as conexões
+ */
+static void phy_policy_refresh(void)
+{
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		if (conn_ctx[i].conn) 
+		{
+			k_work_submit(&conn_ctx[i].phy_work);
+		}
+	}
+}
+
+#endif /* CONFIG_HAL_BLE_PHY_MANAGER */
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - RSSI
  ******************************************************************************/
 
-/**
- * @brief Callback chamado quando uma conexão é estabelecida
- */
-static void on_connected(struct bt_conn *conn, uint8_t err)
+/**
+ * @brief Lê o RSSI da conexão com o comando HCI Read RSSI
+ * 
+ * Bloqueia até a resposta do controlador (Command Complete).
+ * 
+ * @param conn Conexão
+ * @param rssi Ponteiro para armazenar o RSSI em dBm
+ * @return 0 em sucesso, < 0 em erro
+ */
+static int rssi_read_hci(struct bt_conn *conn, int8_t *rssi)
+{
+	struct bt_hci_cp_read_rssi *cp;
+	struct bt_hci_rp_read_rssi *rp;
+	struct net_buf *buf;
+	struct net_buf *rsp = NULL;
+	uint16_t handle;
+	
+	int err = bt_hci_get_conn_handle(conn, &handle);
+	if (err) 
+	{
+		return err;
+	}
+	
+	buf = bt_hci_cmd_create(BT_HCI_OP_READ_RSSI, sizeof(*cp));
+	if (!buf) 
+	{
+		return -ENOBUFS;
+	}
+	
+	cp = net_buf_add(buf, sizeof(*cp));
+	cp->handle = sys_cpu_to_le16(handle);
+	
+	err = bt_hci_cmd_send_sync(BT_HCI_OP_READ_RSSI, buf, &rsp);
+	if (err) 
+	{
+		return err;
+	}
+	
+	rp = (void *)rsp->data;
+	err = (rp->rssi == BT_HCI_LE_RSSI_NOT_AVAILABLE) ? -ENODATA : 0;
+	*rssi = rp->rssi;
+	
+	net_buf_unref(rsp);
+	
+	return err;
+}
+
+/**
+ * @brief Insere uma amostra na fila (lado do produtor)
+ * 
+ * @return true se inserida, false se a fila estava cheia
+ */
+static bool rssi_ring_push(const hal_ble_rssi_sample_t *sample)
+{
+	uint32_t head = (uint32_t)atomic_get(&rssi_head);
+	uint32_t tail = (uint32_t)atomic_get(&rssi_tail);
+	
+	if (head - tail >= RSSI_RING_SIZE) 
+	{
+		return false;
+	}
+	
+	rssi_ring[head & RSSI_RING_MASK] = *sample;
+	
+	// Operação atômica com barreira: a amostra é publicada já escrita
+	atomic_inc(&rssi_head);
+	
+	return true;
+}
+
+/**
+ * @brief Verifica se o RSSI da conexão é amostrado por rssi_work
+ * 
+ * Só a conexão principal é amostrada, e apenas enquanto o controlador não
+ * monitora a perda de percurso.
+ */
+static bool rssi_sampled(const struct ble_conn_ctx *ctx)
+{
+	return ctx->primary && !ctx->path_loss_active && rssi_interval_ms > 0;
+}
+
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+// As amostras da conexão principal também alimentam o controle de potência
+static void txp_rssi_evaluate(struct ble_conn_ctx *ctx, struct bt_conn *conn, int8_t rssi);
+#endif
+
+/**
+ * @brief Handler da amostragem periódica de RSSI
+ * 
+ * Executado na work queue do sistema a cada rssi_interval_ms enquanto
+ * a conexão for a principal. A leitura bloqueia: a amostra é descartada
+ * se a conexão caiu durante a leitura.
+ */
+static void rssi_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct ble_conn_ctx *ctx = CONTAINER_OF(dwork, struct ble_conn_ctx, rssi_work);
+	struct bt_conn *conn = ctx->conn;
+	int8_t rssi;
+	
+	if (!conn || !rssi_sampled(ctx)) 
+	{
+		return;
+	}
+	
+	conn = bt_conn_ref(conn);
+	
+	int err = rssi_read_hci(conn, &rssi);
+	
+	if (ctx->conn != conn) 
+	{
+		bt_conn_unref(conn);
+		return;
+	}
+	
+	if (err) 
+	{
+		LOG_WRN("Falha ao ler RSSI (err %d)", err);
+	}
+	else 
+	{
+		hal_ble_rssi_sample_t sample = {
+			.rssi_dbm = rssi,
+			.conn_id = ctx->id,
+			.timestamp_ms = k_uptime_get_32(),
+		};
+		
+		k_spinlock_key_t key = k_spin_lock(&rssi_lock);
+		rssi_latest = sample;
+		rssi_valid = true;
+		k_spin_unlock(&rssi_lock, key);
+		
+		if (!rssi_ring_push(&sample)) 
+		{
+			LOG_DBG("Fila de RSSI cheia, amostra descartada");
+		}
+		
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+		phy_rssi_evaluate(ctx, rssi);
+#endif
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+		txp_rssi_evaluate(ctx, conn, rssi);
+#endif
+		
+		for (uint8_t i = 0; i < rssi_cb_count; i++) 
+		{
+			rssi_cbs[i](&sample);
+		}
+	}
+	
+	bt_conn_unref(conn);
+	
+	k_work_schedule(&ctx->rssi_work, K_MSEC(rssi_interval_ms));
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - PERDA DE PERCURSO
+ ******************************************************************************/
+
+#if defined(CONFIG_BT_PATH_LOSS_MONITORING)
+
+/**
+ * @brief Configura e habilita o monitoramento no controlador
+ * 
+ * @return 0 em sucesso, < 0 se o controlador não suporta ou recusou
+ */
+static int path_loss_enable(struct bt_conn *conn)
+{
+	const struct bt_conn_le_path_loss_reporting_param param = {
+		.high_threshold = path_loss_params.far_db,
+		.high_hysteresis = path_loss_params.hysteresis_db,
+		.low_threshold = path_loss_params.near_db,
+		.low_hysteresis = path_loss_params.hysteresis_db,
+		.min_time_spent = path_loss_params.min_events,
+	};
+	
+	int err = bt_conn_le_set_path_loss_mon_param(conn, &param);
+	if (err) 
+	{
+		return err;
+	}
+	
+	return bt_conn_le_set_path_loss_mon_enable(conn, true);
+}
+
+/**
+ * @brief Callback do stack quando a perda de percurso muda de zona
+ * 
+ * Perda de percurso indisponível (ex.: central sem LE Power Control, que
+ * não informa a própria potência de transmissão) faz a conexão voltar à
+ * amostragem de RSSI.
+ */
+static void on_path_loss_report(struct bt_conn *conn,
+                                const struct bt_conn_le_path_loss_threshold_report *report)
+{
+	struct ble_conn_ctx *ctx = conn_ctx_find(conn);
+	
+	if (!ctx || !ctx->primary || !ctx->path_loss_active) 
+	{
+		return;
+	}
+	
+	hal_ble_path_loss_zone_t zone;
+	
+	switch (report->zone) {
+	case BT_CONN_LE_PATH_LOSS_ZONE_ENTERED_LOW:
+		zone = HAL_BLE_PATH_LOSS_ZONE_NEAR;
+		break;
+	
+	case BT_CONN_LE_PATH_LOSS_ZONE_ENTERED_MIDDLE:
+		zone = HAL_BLE_PATH_LOSS_ZONE_MIDDLE;
+		break;
+	
+	case BT_CONN_LE_PATH_LOSS_ZONE_ENTERED_HIGH:
+		zone = HAL_BLE_PATH_LOSS_ZONE_FAR;
+		break;
+	
+	default:
+		LOG_WRN("Perda de percurso indisponível, voltando à amostragem de RSSI");
+		ctx->path_loss_active = false;
+		
+		if (rssi_interval_ms > 0) 
+		{
+			k_work_reschedule(&ctx->rssi_work, K_NO_WAIT);
+		}
+		return;
+	}
+	
+	LOG_DBG("Zona de perda de percurso %d (%u dB)", zone, report->path_loss);
+	
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+	// A zona intermediária mantém o PHY atual
+	if (zone != HAL_BLE_PATH_LOSS_ZONE_MIDDLE) 
+	{
+		phy_edge_set(ctx, zone == HAL_BLE_PATH_LOSS_ZONE_FAR);
+	}
+#endif
+	
+	if (path_loss_cb) 
+	{
+		path_loss_cb(zone, report->path_loss);
+	}
+}
+
+#endif /* CONFIG_BT_PATH_LOSS_MONITORING */
+
+/**
+ * @brief Handler que escolhe como acompanhar o enlace da conexão
+ * 
+ * Executado na work queue do sistema ao conectar, ao assumir a conexão
+ * principal e a cada mudança da configuração: tenta o monitoramento pelo
+ * controlador e, sem suporte, mantém a amostragem periódica de RSSI. Só a
+ * conexão principal é acompanhada.
+ */
+static void conn_monitor_work_handler(struct k_work *work)
+{
+	struct ble_conn_ctx *ctx = CONTAINER_OF(work, struct ble_conn_ctx, monitor_work);
+	
+	if (!ctx->conn || !ctx->primary) 
+	{
+		return;
+	}
+	
+#if defined(CONFIG_BT_PATH_LOSS_MONITORING)
+	if (path_loss_cb) 
+	{
+		int err = path_loss_enable(ctx->conn);
+		if (err == 0) 
+		{
+			if (!ctx->path_loss_active) 
+			{
+				LOG_INF("Perda de percurso monitorada pelo controlador (%u-%u dB)",
+				        path_loss_params.near_db, path_loss_params.far_db);
+			}
+			
+			ctx->path_loss_active = true;
+			k_work_cancel_delayable(&ctx->rssi_work);
+			return;
+		}
+		
+		LOG_WRN("Monitoramento de perda de percurso indisponível (err %d), usando RSSI", err);
+	}
+	else if (ctx->path_loss_active) 
+	{
+		bt_conn_le_set_path_loss_mon_enable(ctx->conn, false);
+	}
+#endif
+	
+	ctx->path_loss_active = false;
+	
+	if (rssi_interval_ms > 0 && !k_work_delayable_is_pending(&ctx->rssi_work)) 
+	{
+		k_work_schedule(&ctx->rssi_work, K_NO_WAIT);
+	}
+}
+
+/**
+ * @brief Torna uma conexão a principal
+ * 
+ * Reinicia o acompanhamento do enlace e renegocia os parâmetros com o
+ * perfil da aplicação.
+ */
+static void conn_primary_set(struct ble_conn_ctx *ctx)
+{
+	ctx->primary = true;
+	
+	k_spinlock_key_t key = k_spin_lock(&rssi_lock);
+	rssi_valid = false;
+	k_spin_unlock(&rssi_lock, key);
+	
+	ctx->path_loss_active = false;
+	k_work_submit(&ctx->monitor_work);
+	
+	ctx->param_retries = CONFIG_HAL_BLE_CONN_PARAM_RETRIES;
+	if (ctx->settled) 
+	{
+		k_work_reschedule(&ctx->param_work, K_NO_WAIT);
+	}
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - CALLBACKS DO STACK BLUETOOTH
+ ******************************************************************************/
+
+/**
+ * @brief Callback chamado quando uma conexão é estabelecida
+ */
+static void on_connected(struct bt_conn *conn, uint8_t err)
+{
+	if (err) 
+	{
+		LOG_ERR("Conexão falhou (err %u)", err);
+		
+		// Reinicia advertising
+		k_work_submit(&adv_work);
+		return;
+	}
+	
+	// Armazena referência da conexão em uma entrada livre da tabela
+	struct ble_conn_ctx *ctx = conn_ctx_alloc();
+	if (!ctx) 
+	{
+		LOG_ERR("Tabela de conexões cheia");
+		return;
+	}
+	
+	ctx->conn = bt_conn_ref(conn);
+	ctx->primary = false;
+	conn_count++;
+	current_state = HAL_BLE_STATE_CONNECTED;
+	
+	// Advertising encerrado pela conexão: interrompe o cronograma e volta a
+	// anunciar enquanto houver vaga para outro celular
+	k_work_cancel_delayable(&adv_stage_work);
+	
+	if (conn_count < MAX_CONN) 
+	{
+		k_work_submit(&adv_work);
+	}
+	
+	// Lê informações da conexão
+	struct bt_conn_info info;
+	if (bt_conn_get_info(conn, &info) == 0) 
+	{
+		ctx->interval = info.le.interval;
+		ctx->latency = info.le.latency;
+		ctx->timeout = info.le.timeout;
+		
+		LOG_INF("Conectado (%u/%d) - Intervalo: %u, Latência: %u, Timeout: %u", conn_count, MAX_CONN, info.le.interval, info.le.latency, info.le.timeout);
+	}
+	
+	// PHY em que a conexão foi estabelecida (LE Coded no longo alcance)
+	ctx->phy = HAL_BLE_PHY_1M;
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+	if (bt_conn_get_info(conn, &info) == 0) 
+	{
+		ctx->phy = phy_from_gap(info.le.phy->tx_phy);
+	}
+#endif
+	ctx->phy_since_ms = k_uptime_get();
+	ctx->phy_edge = false;
+	ctx->phy_edge_count = 0;
+	
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+	k_work_submit(&ctx->phy_work);
+#endif
+	
+	// Potência: começa pelo teto e o controle desce conforme o RSSI
+	ctx->tx_power = TX_POWER_UNKNOWN;
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+	ctx->tx_power_req = TXP_MAX_DBM;
+	ctx->tx_down_count = 0;
+	k_work_reschedule(&ctx->txp_work, K_NO_WAIT);
+#endif
+	
+	// Negocia o perfil só depois que a descoberta de serviços se acomodar
+	ctx->settled = false;
+	ctx->param_retries = CONFIG_HAL_BLE_CONN_PARAM_RETRIES;
+	k_work_reschedule(&ctx->param_work, K_MSEC(CONFIG_HAL_BLE_CONN_SETTLE_MS));
+	
+	// A primeira conexão é a principal: o acompanhamento do enlace
+	// (perda de percurso ou RSSI) começa com ela
+	if (!conn_ctx_primary()) 
+	{
+		conn_primary_set(ctx);
+	}
+	
+	// Notifica aplicação
+	if (user_callbacks.connected) 
+	{
+		hal_ble_conn_info_t conn_info;
+		
+		conn_info_fill(ctx, &conn_info);
+		user_callbacks.connected(&conn_info);
+	}
+}
+
+/**
+ * @brief Callback chamado quando uma conexão é encerrada
+ */
+static void on_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	struct ble_conn_ctx *ctx = conn_ctx_find(conn);
+	
+	if (!ctx) 
+	{
+		return;
+	}
+	
+	bool was_primary = ctx->primary;
+	
+	// Libera a entrada da tabela
+	bt_conn_unref(ctx->conn);
+	ctx->conn = NULL;
+	ctx->primary = false;
+	conn_count--;
+	
+	LOG_INF("Desconectado (motivo %u), %u conexão(ões) restante(s)", reason, conn_count);
+	
+	k_work_cancel_delayable(&ctx->param_work);
+	k_work_cancel_delayable(&ctx->rssi_work);
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+	k_work_cancel(&ctx->phy_work);
+#endif
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+	k_work_cancel_delayable(&ctx->txp_work);
+#endif
+	ctx->path_loss_active = false;
+	
+	phy_account(ctx);
+	
+	if (was_primary) 
+	{
+		k_spinlock_key_t key = k_spin_lock(&rssi_lock);
+		rssi_valid = false;
+		k_spin_unlock(&rssi_lock, key);
+		
+		// Outra conexão ativa assume o dome
+		struct ble_conn_ctx *next = conn_ctx_first();
+		if (next) 
+		{
+			LOG_INF("Conexão %u assume como principal", next->id);
+			conn_primary_set(next);
+		}
+		
+		// O beacon passa a acompanhar a nova conexão principal
+		k_work_submit(&adv_tx_work);
+	}
+	
+	// O advertising continua se estava ativo (ainda havia vaga); sem
+	// conexões, volta ao primeiro estágio para acelerar a reconexão
+	if (current_state != HAL_BLE_STATE_ADVERTISING) 
+	{
+		current_state = (conn_count > 0) ? HAL_BLE_STATE_CONNECTED : HAL_BLE_STATE_READY;
+	}
+	else if (conn_count == 0) 
+	{
+		k_work_submit(&adv_restart_work);
+	}
+	
+	// Notifica aplicação
+	if (user_callbacks.disconnected) 
+	{
+		user_callbacks.disconnected(reason);
+	}
+}
+
+/**
+ * @brief Callback chamado quando o central altera os parâmetros da conexão
+ */
+static void on_le_param_updated(struct bt_conn *conn, uint16_t interval,
+                                uint16_t latency, uint16_t timeout)
+{
+	struct ble_conn_ctx *ctx = conn_ctx_find(conn);
+	
+	if (!ctx) 
+	{
+		return;
+	}
+	
+	ctx->interval = interval;
+	ctx->latency = latency;
+	ctx->timeout = timeout;
+	
+	LOG_INF("Conexão %u: parâmetros atualizados - Intervalo: %u, Latência: %u, Timeout: %u",
+	        ctx->id, interval, latency, timeout);
+	
+	// Perfil concedido: encerra as retentativas
+	if (ctx->settled && conn_params_match(ctx, conn_ctx_profile(ctx))) 
+	{
+		k_work_cancel_delayable(&ctx->param_work);
+	}
+	
+	// Notifica aplicação
+	if (user_callbacks.conn_params_updated) 
+	{
+		hal_ble_conn_info_t conn_info;
+		
+		conn_info_fill(ctx, &conn_info);
+		user_callbacks.conn_params_updated(&conn_info);
+	}
+}
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+
+/**
+ * @brief Callback chamado quando o PHY da conexão muda
+ */
+static void on_le_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *param)
+{
+	struct ble_conn_ctx *ctx = conn_ctx_find(conn);
+	
+	if (!ctx) 
+	{
+		return;
+	}
+	
+	hal_ble_phy_t phy = phy_from_gap(param->tx_phy);
+	
+	if (phy == ctx->phy) 
+	{
+		return;
+	}
+	
+	hal_ble_phy_info_t phy_info = {
+		.conn_id = ctx->id,
+		.phy = phy,
+		.prev_phy = ctx->phy,
+		.prev_duration_ms = phy_account(ctx),
+	};
+	
+	k_spinlock_key_t key = k_spin_lock(&phy_lock);
+	phy_stats.switches++;
+	k_spin_unlock(&phy_lock, key);
+	
+	ctx->phy = phy;
+	
+	LOG_INF("Conexão %u: PHY %d -> %d (%u ms no anterior)", ctx->id, phy_info.prev_phy,
+	        phy, phy_info.prev_duration_ms);
+	
+	// Notifica aplicação
+	if (user_callbacks.phy_updated) 
+	{
+		user_callbacks.phy_updated(&phy_info);
+	}
+}
+
+#endif /* CONFIG_BT_USER_PHY_UPDATE */
+
+/**
+ * @brief Callback chamado quando a conexão é reciclada
+ */
+static void on_recycled(void)
+{
+	LOG_DBG("Conexão reciclada - reiniciando advertising");
+	
+	// Reinicia advertising
+	k_work_submit(&adv_work);
+}
+
+// Estrutura de callbacks de conexão
+static struct bt_conn_cb conn_callbacks = {
+	.connected = on_connected,
+	.disconnected = on_disconnected,
+	.le_param_updated = on_le_param_updated,
+	.recycled = on_recycled,
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+	.le_phy_updated = on_le_phy_updated,
+#endif
+#if defined(CONFIG_BT_PATH_LOSS_MONITORING)
+	.path_loss_threshold_report = on_path_loss_report,
+#endif
+};
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - POTÊNCIA DE TRANSMISSÃO
+ ******************************************************************************/
+
+/**
+ * @brief Pede uma potência de transmissão ao controlador
+ * 
+ * Usa o comando HCI vendor Write TX Power Level. O controlador aplica o
+ * nível suportado mais próximo abaixo do pedido e o devolve em
+ * selected_dbm. Bloqueia até a resposta do controlador.
+ * 
+ * @param handle_type BT_HCI_VS_LL_HANDLE_TYPE_ADV ou _CONN
+ * @param handle Handle do conjunto de advertising ou da conexão
+ * @param tx_power_dbm Potência pedida (dBm)
+ * @param selected_dbm Ponteiro para a potência aplicada (pode ser NULL)
+ * @return 0 em sucesso, -ENOTSUP sem suporte no build, < 0 em erro
+ */
+static int tx_power_write(uint8_t handle_type, uint16_t handle, int8_t tx_power_dbm,
+                          int8_t *selected_dbm)
+{
+#if defined(CONFIG_BT_CTLR_TX_PWR_DYNAMIC_CONTROL)
+	struct bt_hci_cp_vs_write_tx_power_level *cp;
+	struct bt_hci_rp_vs_write_tx_power_level *rp;
+	struct net_buf *buf;
+	struct net_buf *rsp = NULL;
+	
+	buf = bt_hci_cmd_create(BT_HCI_OP_VS_WRITE_TX_POWER_LEVEL, sizeof(*cp));
+	if (!buf) 
+	{
+		return -ENOBUFS;
+	}
+	
+	cp = net_buf_add(buf, sizeof(*cp));
+	cp->handle_type = handle_type;
+	cp->handle = sys_cpu_to_le16(handle);
+	cp->tx_power_level = tx_power_dbm;
+	
+	int err = bt_hci_cmd_send_sync(BT_HCI_OP_VS_WRITE_TX_POWER_LEVEL, buf, &rsp);
+	if (err) 
+	{
+		return err;
+	}
+	
+	rp = (void *)rsp->data;
+	if (selected_dbm) 
+	{
+		*selected_dbm = rp->selected_tx_power;
+	}
+	
+	net_buf_unref(rsp);
+	
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+/**
+ * @brief Pede a potência de transmissão de um conjunto de advertising
+ * 
+ * @param adv Conjunto (NULL = advertising legado, handle 0)
+ * @param tx_power_dbm Potência pedida (dBm)
+ * @param selected_dbm Ponteiro para a potência aplicada (pode ser NULL)
+ * @return 0 em sucesso, -ENOTSUP sem suporte no build, < 0 em erro
+ */
+static int adv_tx_power_write(struct bt_le_ext_adv *adv, int8_t tx_power_dbm,
+                              int8_t *selected_dbm)
+{
+	uint16_t handle = 0;
+	
+#if defined(CONFIG_BT_EXT_ADV)
+	if (adv) 
+	{
+		handle = bt_le_ext_adv_get_index(adv);
+	}
+#endif
+	
+	return tx_power_write(BT_HCI_VS_LL_HANDLE_TYPE_ADV, handle, tx_power_dbm, selected_dbm);
+}
+
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+/**
+ * @brief Verifica se a potência deve respeitar o piso do alarme
+ * 
+ * Vale com o alarme tocando e no perfil ALERT (pré-alarme de perda de
+ * enlace), quando o enlace mais precisa de margem.
+ */
+static bool txp_alarm(void)
+{
+	return alarm_active || conn_profile == HAL_BLE_CONN_PROFILE_ALERT;
+}
+#endif
+
+/**
+ * @brief Potência de um conjunto de advertising após o controle adaptativo
+ * 
+ * O beacon (follow_link) acompanha a conexão principal: o radar é o
+ * celular do dono, já conectado, e não precisa de mais potência que o
+ * enlace. O advertising de conexão mantém a potência configurada, pois
+ * procura celulares a distância desconhecida. Durante o alarme, nenhum
+ * conjunto fica abaixo do piso.
+ * 
+ * @param tx_power_dbm Potência configurada do conjunto
+ * @param follow_link Acompanha a potência da conexão principal
+ * @return Potência a pedir ao controlador (dBm)
+ */
+static int8_t adv_tx_power_target(int8_t tx_power_dbm, bool follow_link)
+{
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+	struct ble_conn_ctx *ctx = conn_ctx_primary();
+	
+	if (follow_link && ctx && ctx->tx_power != TX_POWER_UNKNOWN &&
+	    ctx->tx_power_req < tx_power_dbm) 
+	{
+		tx_power_dbm = ctx->tx_power_req;
+	}
+	
+	if (txp_alarm()) 
+	{
+		tx_power_dbm = MAX(tx_power_dbm, TXP_ALARM_FLOOR_DBM);
+	}
+#endif
+	
+	return tx_power_dbm;
+}
+
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+
+/**
+ * @brief Piso do controle de potência (mais alto durante o alarme)
+ */
+static int8_t txp_floor(void)
+{
+	return txp_alarm() ? MAX(TXP_MIN_DBM, TXP_ALARM_FLOOR_DBM) : TXP_MIN_DBM;
+}
+
+/**
+ * @brief Potência que entrega ao celular o RSSI alvo
+ * 
+ * Supõe o canal recíproco: a perda de percurso é a potência presumida do
+ * celular menos o RSSI recebido dele, e vale também no sentido da
+ * coleira para o celular.
+ * 
+ * @param rssi RSSI dos pacotes do celular (dBm)
+ * @return Potência desejada, entre o piso e o teto do controle (dBm)
+ */
+static int8_t txp_desired(int8_t rssi)
+{
+	int32_t path_loss = CONFIG_HAL_BLE_PEER_TX_POWER_DBM - rssi;
+	int32_t tx_power = CONFIG_HAL_BLE_TX_POWER_TARGET_RSSI_DBM + path_loss;
+	
+	return (int8_t)CLAMP(tx_power, txp_floor(), TXP_MAX_DBM);
+}
+
+/**
+ * @brief Aplica a potência pedida a uma conexão
+ * 
+ * @param ctx Entrada da tabela da conexão
+ * @param conn Referência à conexão tomada pelo chamador
+ * @param tx_power_dbm Potência pedida (dBm)
+ */
+static void txp_conn_apply(struct ble_conn_ctx *ctx, struct bt_conn *conn, int8_t tx_power_dbm)
+{
+	uint16_t handle;
+	int8_t selected;
+	
+	int err = bt_hci_get_conn_handle(conn, &handle);
+	if (!err) 
+	{
+		err = tx_power_write(BT_HCI_VS_LL_HANDLE_TYPE_CONN, handle, tx_power_dbm, &selected);
+	}
+	if (err) 
+	{
+		LOG_WRN("Falha ao ajustar potência da conexão %u (err %d)", ctx->id, err);
+		return;
+	}
+	
+	LOG_DBG("Conexão %u: %d dBm (pedido %d dBm)", ctx->id, selected, tx_power_dbm);
+	
+	ctx->tx_power_req = tx_power_dbm;
+	ctx->tx_power = selected;
+	
+	// O beacon acompanha a conexão principal
+	if (ctx->primary) 
+	{
+		k_work_submit(&adv_tx_work);
+	}
+}
+
+/**
+ * @brief Recalcula a potência de uma conexão a partir de uma amostra de RSSI
+ * 
+ * Começa pelo teto e, a cada amostra do RSSI dos pacotes do celular,
+ * recalcula a potência: sobe na hora (a margem do enlace vem primeiro) e
+ * desce um passo de cada vez, depois de TXP_DOWN_SAMPLES amostras
+ * seguidas com folga de pelo menos um passo.
+ * 
+ * @param ctx Entrada da tabela da conexão
+ * @param conn Referência à conexão tomada pelo chamador
+ * @param rssi RSSI dos pacotes do celular (dBm)
+ */
+static void txp_rssi_evaluate(struct ble_conn_ctx *ctx, struct bt_conn *conn, int8_t rssi)
+{
+	int8_t desired = txp_desired(rssi);
+	
+	if (ctx->tx_power == TX_POWER_UNKNOWN) 
+	{
+		txp_conn_apply(ctx, conn, MAX(ctx->tx_power_req, desired));
+	}
+	else if (desired > ctx->tx_power_req) 
+	{
+		ctx->tx_down_count = 0;
+		txp_conn_apply(ctx, conn, desired);
+	}
+	else if (desired <= ctx->tx_power_req - TXP_STEP_DB) 
+	{
+		if (++ctx->tx_down_count >= TXP_DOWN_SAMPLES) 
+		{
+			ctx->tx_down_count = 0;
+			txp_conn_apply(ctx, conn, ctx->tx_power_req - TXP_STEP_DB);
+		}
+	}
+	else 
+	{
+		ctx->tx_down_count = 0;
+	}
+}
+
+/**
+ * @brief Handler do controle adaptativo da potência de uma conexão
+ * 
+ * A conexão principal já tem o RSSI amostrado por rssi_work, que alimenta
+ * o controle (txp_rssi_evaluate()): aqui ela só recebe a potência inicial
+ * e o piso do alarme, sem um segundo Read RSSI no HCI. As demais conexões
+ * leem o próprio RSSI a cada CONFIG_HAL_BLE_TX_POWER_INTERVAL_MS.
+ * 
+ * A leitura do RSSI bloqueia: o handler trabalha sobre uma referência
+ * própria da conexão e descarta o resultado se ela caiu (ou a entrada foi
+ * reutilizada por outra conexão) durante a leitura.
+ */
+static void txp_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct ble_conn_ctx *ctx = CONTAINER_OF(dwork, struct ble_conn_ctx, txp_work);
+	struct bt_conn *conn = ctx->conn;
+	int8_t rssi;
+	
+	if (!conn) 
+	{
+		return;
+	}
+	
+	conn = bt_conn_ref(conn);
+	
+	if (rssi_sampled(ctx)) 
+	{
+		int8_t floor = txp_floor();
+		
+		if (ctx->tx_power == TX_POWER_UNKNOWN || ctx->tx_power_req < floor) 
+		{
+			txp_conn_apply(ctx, conn, MAX(ctx->tx_power_req, floor));
+		}
+	}
+	else 
+	{
+		int err = rssi_read_hci(conn, &rssi);
+		
+		if (ctx->conn != conn) 
+		{
+			bt_conn_unref(conn);
+			return;
+		}
+		
+		if (err) 
+		{
+			LOG_DBG("RSSI indisponível para o controle de potência (err %d)", err);
+		}
+		else 
+		{
+			txp_rssi_evaluate(ctx, conn, rssi);
+		}
+	}
+	
+	bt_conn_unref(conn);
+	
+	k_work_schedule(&ctx->txp_work, K_MSEC(CONFIG_HAL_BLE_TX_POWER_INTERVAL_MS));
+}
+
+#endif /* CONFIG_HAL_BLE_TX_POWER_CONTROL */
+
+/**
+ * @brief Reavalia a potência das conexões e dos conjuntos de advertising
+ * 
+ * Chamada quando o piso do alarme muda: a subida é imediata.
+ */
+static void txp_refresh(void)
+{
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		if (conn_ctx[i].conn) 
+		{
+			k_work_reschedule(&conn_ctx[i].txp_work, K_NO_WAIT);
+		}
+	}
+#endif
+	
+	k_work_submit(&adv_tx_work);
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - ADVERTISING
+ ******************************************************************************/
+
+/**
+ * @brief Aplica a potência do advertising de conexão
+ * 
+ * Sem suporte a potência dinâmica no build, o controlador mantém a
+ * potência padrão sem aviso.
+ */
+static void conn_adv_tx_power_apply(void)
+{
+	int8_t selected;
+	
+	int8_t tx_power = adv_tx_power_target(conn_adv_tx_power, false);
+	
+	int err = adv_tx_power_write(conn_adv, tx_power, &selected);
+	if (err == -ENOTSUP) 
+	{
+		return;
+	}
+	
+	if (err) 
+	{
+		LOG_WRN("Falha ao ajustar potência do advertising (err %d)", err);
+		return;
+	}
+	
+	LOG_DBG("Advertising de conexão: %d dBm (pedido %d dBm)", selected, tx_power);
+}
+
+/**
+ * @brief Inicia o advertising de conexão com adv_param_storage
+ * 
+ * Com advertising estendido habilitado, o advertising de conexão é um
+ * conjunto próprio, criado no primeiro início, que convive com o beacon
+ * e o trem periódico e tem potência independente. Sem ele, usa a API
+ * legada (handle 0 no controlador).
+ * 
+ * @return 0 em sucesso, < 0 em erro
+ */
+static int conn_adv_start(void)
+{
+	int err;
+	
+#if defined(CONFIG_BT_EXT_ADV)
+	if (!conn_adv) 
+	{
+		err = bt_le_ext_adv_create(&adv_param_storage, NULL, &conn_adv);
+	}
+	else 
+	{
+		err = bt_le_ext_adv_update_param(conn_adv, &adv_param_storage);
+	}
+	if (err) 
+	{
+		return err;
+	}
+	
+	err = bt_le_ext_adv_set_data(conn_adv, ad_data, ad_data_count, sd_data, sd_data_count);
+	if (err) 
+	{
+		return err;
+	}
+	
+	conn_adv_tx_power_apply();
+	
+	return bt_le_ext_adv_start(conn_adv, BT_LE_EXT_ADV_START_DEFAULT);
+#else
+	err = bt_le_adv_start(&adv_param_storage, ad_data, ad_data_count,
+	                      sd_data, sd_data_count);
+	if (err) 
+	{
+		return err;
+	}
+	
+	// O advertising legado só existe no controlador depois de iniciado
+	conn_adv_tx_power_apply();
+	
+	return 0;
+#endif
+}
+
+/**
+ * @brief Para o advertising de conexão
+ * 
+ * @return 0 em sucesso, < 0 em erro
+ */
+static int conn_adv_stop(void)
+{
+#if defined(CONFIG_BT_EXT_ADV)
+	return conn_adv ? bt_le_ext_adv_stop(conn_adv) : 0;
+#else
+	return bt_le_adv_stop();
+#endif
+}
+
+/**
+ * @brief Troca os dados do advertising de conexão em andamento
+ * 
+ * @return 0 em sucesso, < 0 em erro
+ */
+static int conn_adv_update_data(void)
+{
+#if defined(CONFIG_BT_EXT_ADV)
+	return bt_le_ext_adv_set_data(conn_adv, ad_data, ad_data_count, sd_data, sd_data_count);
+#else
+	return bt_le_adv_update_data(ad_data, ad_data_count, sd_data, sd_data_count);
+#endif
+}
+
+/**
+ * @brief Copia o estado informado pela aplicação para os dados de advertising
+ */
+static void adv_status_commit(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&adv_status_lock);
+	adv_status_data = adv_status;
+	k_spin_unlock(&adv_status_lock, key);
+}
+
+/**
+ * @brief Inicia o advertising com os intervalos de um estágio do cronograma
+ * 
+ * Agenda a troca para o próximo estágio ao fim da duração deste.
+ * 
+ * @param stage Índice do estágio
+ * @return 0 em sucesso, < 0 em erro
+ */
+static int adv_start_stage(uint8_t stage)
+{
+	const hal_ble_adv_stage_t *entry = &adv_schedule[stage];
+	
+	adv_param_storage.id = 0;
+	adv_param_storage.sid = 0;
+	adv_param_storage.secondary_max_skip = 0;
+	adv_param_storage.options = adv_options;
+	
+	// Longo alcance: advertising estendido no LE Coded (primário e secundário)
+	if (IS_ENABLED(CONFIG_HAL_BLE_LONG_RANGE)) 
+	{
+		adv_param_storage.options |= BT_LE_ADV_OPT_EXT_ADV | BT_LE_ADV_OPT_CODED;
+	}
+	adv_param_storage.interval_min = MS_TO_BLE_UNITS(entry->interval_min_ms);
+	adv_param_storage.interval_max = MS_TO_BLE_UNITS(entry->interval_max_ms);
+	adv_param_storage.peer = NULL;
+	
+	adv_status_commit();
+	
+	int err = conn_adv_start();
+	if (err) 
+	{
+		return err;
+	}
+	
+	adv_stage = stage;
+	
+	LOG_INF("Advertising estágio %u: %u-%u ms", stage, entry->interval_min_ms,
+	        entry->interval_max_ms);
+	
+	// O último estágio dura indefinidamente
+	if (stage + 1 < adv_stage_count && entry->duration_s > 0) 
+	{
+		k_work_schedule(&adv_stage_work, K_SECONDS(entry->duration_s));
+	}
+	
+	return 0;
+}
+
+/**
+ * @brief Troca o estágio do advertising em andamento
+ * 
+ * O controlador não permite alterar o intervalo de um advertising em
+ * andamento: para e reinicia com os parâmetros do novo estágio.
+ * 
+ * @param stage Índice do novo estágio
+ */
+static void adv_switch_stage(uint8_t stage)
+{
+	int err = conn_adv_stop();
+	if (err) 
+	{
+		LOG_ERR("Falha ao parar advertising para troca de estágio (err %d)", err);
+		return;
+	}
+	
+	err = adv_start_stage(stage);
+	if (err) 
+	{
+		LOG_ERR("Falha ao iniciar estágio %u do advertising (err %d)", stage, err);
+		
+		// Uma conexão pode ter sido estabelecida entre a parada e o reinício
+		if (current_state == HAL_BLE_STATE_ADVERTISING) 
+		{
+			current_state = HAL_BLE_STATE_READY;
+			
+			if (user_callbacks.adv_stopped) 
+			{
+				user_callbacks.adv_stopped();
+			}
+		}
+	}
+}
+
+/**
+ * @brief Handler da troca de estágio do cronograma de advertising
+ */
+static void adv_stage_work_handler(struct k_work *work)
+{
+	if (current_state != HAL_BLE_STATE_ADVERTISING) 
+	{
+		return;
+	}
+	
+	adv_switch_stage(adv_stage + 1);
+}
+
+/**
+ * @brief Handler do reinício do cronograma após a última desconexão
+ * 
+ * O advertising que aguardava outro celular está no último estágio; sem
+ * conexões, volta ao primeiro para acelerar a reconexão.
+ */
+static void adv_restart_work_handler(struct k_work *work)
+{
+	if (current_state != HAL_BLE_STATE_ADVERTISING || conn_count > 0 || adv_stage == 0) 
+	{
+		return;
+	}
+	
+	k_work_cancel_delayable(&adv_stage_work);
+	
+	adv_switch_stage(0);
+}
+
+/**
+ * @brief Handler do work item para iniciar advertising
+ * 
+ * Sem conexões, começa pelo primeiro estágio do cronograma: após uma
+ * desconexão, o intervalo curto acelera a reconexão. Com celulares já
+ * conectados, o advertising que aguarda outro celular vai direto ao
+ * último estágio, o mais econômico.
+ */
+static void adv_work_handler(struct k_work *work)
+{
+	if (conn_count >= MAX_CONN) 
+	{
+		LOG_DBG("Sem vaga para novas conexões, não inicia advertising");
+		return;
+	}
+	
+	if (current_state == HAL_BLE_STATE_ADVERTISING) 
+	{
+		return;
+	}
+	
+	k_work_cancel_delayable(&adv_stage_work);
+	
+	// Inicia advertising
+	int err = adv_start_stage((conn_count > 0) ? adv_stage_count - 1 : 0);
+	if (err) 
+	{
+		LOG_ERR("Advertising falhou (err %d)", err);
+		return;
+	}
+	
+	current_state = HAL_BLE_STATE_ADVERTISING;
+	LOG_INF("Advertising iniciado");
+	
+	// Notifica aplicação
+	if (user_callbacks.adv_started) 
+	{
+		user_callbacks.adv_started();
+	}
+}
+
+/**
+ * @brief Preenche o campo AD do nome dentro do espaço restante do PDU
+ * 
+ * @param data Campo a preencher
+ * @param name_len Tamanho do nome do dispositivo
+ * @param max_len Bytes disponíveis para o nome
+ */
+static void adv_name_fill(struct bt_data *data, size_t name_len, size_t max_len)
+{
+	data->type = (name_len > max_len) ? BT_DATA_NAME_SHORTENED : BT_DATA_NAME_COMPLETE;
+	data->data_len = MIN(name_len, max_len);
+	data->data = (const uint8_t *)device_name;
+}
+
+/**
+ * @brief Prepara os dados de advertising
+ */
+static void prepare_adv_data(void)
+{
+	size_t name_len = strlen(device_name);
+	
+	// Espaço do nome no PDU legado: descontados flags, estado da coleira e,
+	// no longo alcance, o UUID (PDU estendido, sem abreviar)
+	size_t name_max = ADV_LEGACY_DATA_LEN - (AD_FIELD_HDR_LEN + 1) -
+	                  (AD_FIELD_HDR_LEN + sizeof(adv_status_data)) - AD_FIELD_HDR_LEN;
+	
+	if (IS_ENABLED(CONFIG_HAL_BLE_LONG_RANGE)) 
+	{
+		name_max = name_len;
+	}
+	
+	// Advertising data
+	ad_data_count = 0;
+	
+	// Flags
+	ad_data[ad_data_count].type = BT_DATA_FLAGS;
+	ad_data[ad_data_count].data_len = 1;
+	static const uint8_t flags = BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR;
+	ad_data[ad_data_count].data = &flags;
+	ad_data_count++;
+	
+	// Nome do dispositivo
+	if (name_len > 0) 
+	{
+		adv_name_fill(&ad_data[ad_data_count], name_len, name_max);
+		ad_data_count++;
+	}
+	
+	// Estado da coleira (bateria, alarme) para quem apenas escaneia
+	ad_data[ad_data_count].type = BT_DATA_MANUFACTURER_DATA;
+	ad_data[ad_data_count].data_len = sizeof(adv_status_data);
+	ad_data[ad_data_count].data = (const uint8_t *)&adv_status_data;
+	ad_data_count++;
+	
+	// Scan response data
+	sd_data_count = 0;
+	
+	// UUID do serviço customizado Buzzer Service (declaração estática)
+	static const struct bt_uuid_128 buzzer_uuid = BT_UUID_INIT_128(BT_UUID_BUZZER_SERVICE_VAL);
+	
+	// O advertising estendido conectável não tem scan response: no longo
+	// alcance o UUID vai nos dados de advertising
+	struct bt_data *uuid_data = IS_ENABLED(CONFIG_HAL_BLE_LONG_RANGE) ?
+	                            &ad_data[ad_data_count++] : &sd_data[sd_data_count++];
+	
+	uuid_data->type = BT_DATA_UUID128_ALL;
+	uuid_data->data_len = 16;
+	uuid_data->data = buzzer_uuid.val;
+	
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+	// Trem periódico: o estado nos dados periódicos e o nome no
+	// advertising estendido que leva a sync info
+	per_ad_data[0].type = BT_DATA_MANUFACTURER_DATA;
+	per_ad_data[0].data_len = sizeof(adv_status_data);
+	per_ad_data[0].data = (const uint8_t *)&adv_status_data;
+	
+	per_ext_ad_data_count = 0;
+	if (name_len > 0) 
+	{
+		per_ext_ad_data[0].type = BT_DATA_NAME_COMPLETE;
+		per_ext_ad_data[0].data_len = name_len;
+		per_ext_ad_data[0].data = (const uint8_t *)device_name;
+		per_ext_ad_data_count = 1;
+	}
+#endif
+	
+#if defined(CONFIG_HAL_BLE_BEACON)
+	// Beacon: nome, potência anunciada (perda de percurso no radar) e
+	// estado da coleira, dentro dos 31 bytes de um PDU legado
+	static const uint8_t beacon_flags = BT_LE_AD_NO_BREDR;
+	
+	beacon_ad_data_count = 0;
+	beacon_ad_data[beacon_ad_data_count].type = BT_DATA_FLAGS;
+	beacon_ad_data[beacon_ad_data_count].data_len = 1;
+	beacon_ad_data[beacon_ad_data_count].data = &beacon_flags;
+	beacon_ad_data_count++;
+	
+	if (name_len > 0) 
+	{
+		size_t beacon_name_max = ADV_LEGACY_DATA_LEN - (AD_FIELD_HDR_LEN + 1) -
+		                         (AD_FIELD_HDR_LEN + sizeof(beacon_tx_power_ad)) -
+		                         (AD_FIELD_HDR_LEN + sizeof(adv_status_data)) - AD_FIELD_HDR_LEN;
+		
+		adv_name_fill(&beacon_ad_data[beacon_ad_data_count], name_len, beacon_name_max);
+		beacon_ad_data_count++;
+	}
+	
+	beacon_ad_data[beacon_ad_data_count].type = BT_DATA_TX_POWER;
+	beacon_ad_data[beacon_ad_data_count].data_len = 1;
+	beacon_ad_data[beacon_ad_data_count].data = (const uint8_t *)&beacon_tx_power_ad;
+	beacon_ad_data_count++;
+	
+	beacon_ad_data[beacon_ad_data_count].type = BT_DATA_MANUFACTURER_DATA;
+	beacon_ad_data[beacon_ad_data_count].data_len = sizeof(adv_status_data);
+	beacon_ad_data[beacon_ad_data_count].data = (const uint8_t *)&adv_status_data;
+	beacon_ad_data_count++;
+#endif
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - ADVERTISING PERIÓDICO
+ ******************************************************************************/
+
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+
+/**
+ * @brief Handler que aplica o estado solicitado do trem periódico
+ * 
+ * Cria o conjunto de advertising estendido na primeira ativação e o
+ * mantém: desativar só para o trem e o advertising que leva a sync info.
+ * A troca de intervalo exige parar o trem (o controlador não aceita novos
+ * parâmetros com o periódico ativo).
+ */
+static void per_adv_work_handler(struct k_work *work)
+{
+	int err;
+	
+	if (!per_adv_enable) 
+	{
+		if (per_adv_running) 
+		{
+			bt_le_per_adv_stop(per_adv);
+			bt_le_ext_adv_stop(per_adv);
+			per_adv_running = false;
+			LOG_INF("Advertising periódico parado");
+		}
+		return;
+	}
+	
+	if (!per_adv) 
+	{
+		// Não conectável e não escaneável: só anuncia o nome e a sync info
+		struct bt_le_adv_param param = {
+			.id = 0,
+			.sid = PER_ADV_SID,
+			.options = BT_LE_ADV_OPT_EXT_ADV | BT_LE_ADV_OPT_USE_IDENTITY,
+			.interval_min = MS_TO_BLE_UNITS(PER_ADV_EXT_INTERVAL_MS),
+			.interval_max = MS_TO_BLE_UNITS(PER_ADV_EXT_INTERVAL_MS),
+		};
+		
+		// Longo alcance: o trem acompanha o advertising no LE Coded
+		if (IS_ENABLED(CONFIG_HAL_BLE_LONG_RANGE)) 
+		{
+			param.options |= BT_LE_ADV_OPT_CODED;
+		}
+		
+		err = bt_le_ext_adv_create(&param, NULL, &per_adv);
+		if (err) 
+		{
+			LOG_ERR("Falha ao criar conjunto do advertising periódico (err %d)", err);
+			return;
+		}
+		
+		// Nome, para o observador achar o trem antes de sincronizar
+		err = bt_le_ext_adv_set_data(per_adv, per_ext_ad_data, per_ext_ad_data_count, NULL, 0);
+		if (err) 
+		{
+			LOG_WRN("Falha ao definir dados do advertising estendido (err %d)", err);
+		}
+	}
+	
+	if (per_adv_running) 
+	{
+		bt_le_per_adv_stop(per_adv);
+	}
+	
+	const struct bt_le_per_adv_param per_param = {
+		.interval_min = MS_TO_CONN_UNITS(per_adv_interval_ms),
+		.interval_max = MS_TO_CONN_UNITS(per_adv_interval_ms),
+		.options = BT_LE_PER_ADV_OPT_NONE,
+	};
+	
+	err = bt_le_per_adv_set_param(per_adv, &per_param);
+	if (err) 
+	{
+		LOG_ERR("Falha ao configurar advertising periódico (err %d)", err);
+		return;
+	}
+	
+	adv_status_commit();
+	
+	err = bt_le_per_adv_set_data(per_adv, per_ad_data, ARRAY_SIZE(per_ad_data));
+	if (err) 
+	{
+		LOG_ERR("Falha ao definir dados do advertising periódico (err %d)", err);
+		return;
+	}
+	
+	err = bt_le_per_adv_start(per_adv);
+	if (err) 
+	{
+		LOG_ERR("Falha ao iniciar advertising periódico (err %d)", err);
+		return;
+	}
+	
+	if (!per_adv_running) 
+	{
+		err = bt_le_ext_adv_start(per_adv, BT_LE_EXT_ADV_START_DEFAULT);
+		if (err) 
+		{
+			LOG_ERR("Falha ao iniciar advertising estendido (err %d)", err);
+			bt_le_per_adv_stop(per_adv);
+			return;
+		}
+	}
+	
+	per_adv_running = true;
+	LOG_INF("Advertising periódico iniciado: %u ms", per_adv_interval_ms);
+}
+
+#endif /* CONFIG_HAL_BLE_PERIODIC_ADV */
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - BEACON
+ ******************************************************************************/
+
+#if defined(CONFIG_HAL_BLE_BEACON)
+
+/**
+ * @brief Aplica a potência do beacon
+ * 
+ * O TX Power Level anunciado acompanha a potência escolhida pelo
+ * controlador, para o aplicativo de radar estimar a perda de percurso.
+ */
+static void beacon_tx_power_apply(void)
+{
+	int8_t tx_power = adv_tx_power_target(beacon_params.tx_power_dbm, true);
+	int8_t selected = tx_power;
+	
+	int err = adv_tx_power_write(beacon_adv, tx_power, &selected);
+	if (err && err != -ENOTSUP) 
+	{
+		LOG_WRN("Falha ao ajustar potência do beacon (err %d)", err);
+	}
+	
+	beacon_tx_power_ad = selected;
+}
+
+/**
+ * @brief Handler que aplica o estado solicitado do beacon
+ * 
+ * O beacon usa PDUs legados não conectáveis e não escaneáveis
+ * (ADV_NONCONN_IND): todo celular o enxerga, e o rádio não abre janela
+ * de recepção após cada pacote, ao contrário do advertising de conexão.
+ * O conjunto é criado na primeira ativação e mantido.
+ */
+static void beacon_work_handler(struct k_work *work)
+{
+	int err;
+	
+	// Parâmetros só mudam com o conjunto parado
+	if (beacon_running) 
+	{
+		bt_le_ext_adv_stop(beacon_adv);
+		beacon_running = false;
+		
+		if (!beacon_enable) 
+		{
+			LOG_INF("Beacon parado");
+		}
+	}
+	
+	if (!beacon_enable) 
+	{
+		return;
+	}
+	
+	const struct bt_le_adv_param param = {
+		.id = 0,
+		.sid = BEACON_SID,
+		.options = BT_LE_ADV_OPT_USE_IDENTITY,
+		.interval_min = MS_TO_BLE_UNITS(beacon_params.interval_ms),
+		.interval_max = MS_TO_BLE_UNITS(beacon_params.interval_ms),
+	};
+	
+	if (!beacon_adv) 
+	{
+		err = bt_le_ext_adv_create(&param, NULL, &beacon_adv);
+	}
+	else 
+	{
+		err = bt_le_ext_adv_update_param(beacon_adv, &param);
+	}
+	if (err) 
+	{
+		LOG_ERR("Falha ao configurar conjunto do beacon (err %d)", err);
+		return;
+	}
+	
+	beacon_tx_power_apply();
+	adv_status_commit();
+	
+	err = bt_le_ext_adv_set_data(beacon_adv, beacon_ad_data, beacon_ad_data_count, NULL, 0);
+	if (err) 
+	{
+		LOG_ERR("Falha ao definir dados do beacon (err %d)", err);
+		return;
+	}
+	
+	err = bt_le_ext_adv_start(beacon_adv, BT_LE_EXT_ADV_START_DEFAULT);
+	if (err) 
+	{
+		LOG_ERR("Falha ao iniciar beacon (err %d)", err);
+		return;
+	}
+	
+	beacon_running = true;
+	LOG_INF("Beacon iniciado: %u ms, %d dBm", beacon_params.interval_ms, beacon_tx_power_ad);
+}
+
+#endif /* CONFIG_HAL_BLE_BEACON */
+
+/**
+ * @brief Handler da troca de potência dos conjuntos de advertising
+ * 
+ * Aplica a nova potência aos conjuntos em andamento sem pará-los; os
+ * parados recebem a potência no próximo início.
+ */
+static void adv_tx_work_handler(struct k_work *work)
+{
+	if (current_state == HAL_BLE_STATE_ADVERTISING) 
+	{
+		conn_adv_tx_power_apply();
+	}
+	
+#if defined(CONFIG_HAL_BLE_BEACON)
+	if (beacon_running) 
+	{
+		beacon_tx_power_apply();
+		
+		int err = bt_le_ext_adv_set_data(beacon_adv, beacon_ad_data, beacon_ad_data_count,
+		                                 NULL, 0);
+		if (err) 
+		{
+			LOG_WRN("Falha ao atualizar dados do beacon (err %d)", err);
+		}
+	}
+#endif
+}
+
+/**
+ * @brief Handler da troca dos dados de fabricante
+ * 
+ * Atualiza o advertising, o beacon e o trem periódico em andamento sem
+ * pará-los.
+ * Sem advertising, o estado novo entra no próximo início.
+ */
+static void adv_update_work_handler(struct k_work *work)
+{
+	int err;
+	
+	adv_status_commit();
+	
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+	if (per_adv_running) 
+	{
+		err = bt_le_per_adv_set_data(per_adv, per_ad_data, ARRAY_SIZE(per_ad_data));
+		if (err) 
+		{
+			LOG_WRN("Falha ao atualizar dados do advertising periódico (err %d)", err);
+		}
+	}
+#endif
+	
+#if defined(CONFIG_HAL_BLE_BEACON)
+	if (beacon_running) 
+	{
+		err = bt_le_ext_adv_set_data(beacon_adv, beacon_ad_data, beacon_ad_data_count,
+		                             NULL, 0);
+		if (err) 
+		{
+			LOG_WRN("Falha ao atualizar dados do beacon (err %d)", err);
+		}
+	}
+#endif
+	
+	if (current_state == HAL_BLE_STATE_ADVERTISING) 
+	{
+		err = conn_adv_update_data();
+		if (err) 
+		{
+			LOG_WRN("Falha ao atualizar dados de advertising (err %d)", err);
+		}
+	}
+	
+	LOG_DBG("Estado anunciado: seq %u, bateria %u%%, flags 0x%02x", adv_status_data.seq,
+	        adv_status_data.battery_pct, adv_status_data.flags);
+}
+
+/*******************************************************************************
+ * API PÚBLICA
+ ******************************************************************************/
+
+int hal_ble_init(const char *device_name_param, const hal_ble_callbacks_t *callbacks)
+{
+	if (initialized) 
+	{
+		LOG_WRN("HAL BLE já inicializado");
+		return HAL_BLE_SUCCESS;
+	}
+	
+	// Valida parâmetros
+	if (!device_name_param) 
+	{
+		LOG_ERR("Nome do dispositivo não pode ser NULL");
+		return HAL_BLE_ERROR_INVALID;
+	}
+	
+	size_t name_len = strlen(device_name_param);
+	if (name_len > MAX_DEVICE_NAME_LEN) 
+	{
+		LOG_ERR("Nome do dispositivo muito longo (max %d caracteres)", MAX_DEVICE_NAME_LEN);
+		return HAL_BLE_ERROR_INVALID;
+	}
+	
+	// Armazena nome do dispositivo
+	strncpy(device_name, device_name_param, MAX_DEVICE_NAME_LEN);
+	device_name[MAX_DEVICE_NAME_LEN] = '\0';
+	
+	// Armazena callbacks
+	if (callbacks) 
+	{
+		user_callbacks = *callbacks;
+	}
+	
+	// Habilita Bluetooth
+	int err = bt_enable(NULL);
+	if (err) 
+	{
+		LOG_ERR("Falha ao habilitar Bluetooth (err %d)", err);
+		return HAL_BLE_ERROR_INIT;
+	}
+	
+	LOG_INF("Bluetooth habilitado");
+	
+	// Registra callbacks de conexão
+	bt_conn_cb_register(&conn_callbacks);
+	
+	// Inicializa serviço customizado MY LBS
+	// (callbacks do serviço serão registrados pela aplicação)
+	
+	// Prepara dados de advertising
+	prepare_adv_data();
+	
+	// Inicializa work items para advertising
+	k_work_init(&adv_work, adv_work_handler);
+	k_work_init_delayable(&adv_stage_work, adv_stage_work_handler);
+	k_work_init(&adv_restart_work, adv_restart_work_handler);
+	k_work_init(&adv_update_work, adv_update_work_handler);
+	k_work_init(&adv_tx_work, adv_tx_work_handler);
+#if defined(CONFIG_HAL_BLE_BEACON)
+	k_work_init(&beacon_work, beacon_work_handler);
+#endif
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+	k_work_init(&per_adv_work, per_adv_work_handler);
+#endif
+	
+	// Inicializa os work items de cada entrada da tabela de conexões:
+	// negociação de parâmetros e acompanhamento do enlace
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		conn_ctx[i].id = i;
+		k_work_init_delayable(&conn_ctx[i].param_work, conn_param_work_handler);
+		k_work_init_delayable(&conn_ctx[i].rssi_work, rssi_work_handler);
+		k_work_init(&conn_ctx[i].monitor_work, conn_monitor_work_handler);
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+		k_work_init(&conn_ctx[i].phy_work, phy_work_handler);
+#endif
+#if defined(CONFIG_HAL_BLE_TX_POWER_CONTROL)
+		k_work_init_delayable(&conn_ctx[i].txp_work, txp_work_handler);
+#endif
+	}
+	
+	// Estado pronto
+	current_state = HAL_BLE_STATE_READY;
+	initialized = true;
+	
+	LOG_INF("HAL BLE inicializado - Device: %s", device_name);
+	return HAL_BLE_SUCCESS;
+}
+
+int hal_ble_start_advertising(const hal_ble_adv_params_t *adv_params)
+{
+	if (!initialized) 
+	{
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	if (conn_count >= MAX_CONN) 
+	{
+		LOG_WRN("Todas as conexões ocupadas, não pode iniciar advertising");
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	if (current_state == HAL_BLE_STATE_ADVERTISING) 
+	{
+		LOG_WRN("Advertising já está ativo");
+		return HAL_BLE_SUCCESS;
+	}
+	
+	// Configura parâmetros de advertising
+	if (adv_params) 
+	{
+		// Cronograma informado ou estágio único com o intervalo fixo
+		const hal_ble_adv_stage_t fixed = {
+			.interval_min_ms = adv_params->interval_min_ms,
+			.interval_max_ms = adv_params->interval_max_ms,
+			.duration_s = 0,
+		};
+		const hal_ble_adv_stage_t *stages = adv_params->stages ? adv_params->stages : &fixed;
+		uint8_t stage_count = adv_params->stages ? adv_params->stage_count : 1;
+		
+		if (stage_count == 0 || stage_count > HAL_BLE_ADV_MAX_STAGES) 
+		{
+			LOG_ERR("Cronograma de advertising inválido (%u estágios)", stage_count);
+			return HAL_BLE_ERROR_INVALID;
+		}
+		
+		// Valida parâmetros
+		for (uint8_t i = 0; i < stage_count; i++) 
+		{
+			if (stages[i].interval_min_ms < ADV_INTERVAL_MIN_MS ||
+			    stages[i].interval_min_ms > ADV_INTERVAL_MAX_MS ||
+			    stages[i].interval_max_ms < ADV_INTERVAL_MIN_MS ||
+			    stages[i].interval_max_ms > ADV_INTERVAL_MAX_MS ||
+			    stages[i].interval_min_ms > stages[i].interval_max_ms) {
+				LOG_ERR("Parâmetros de advertising inválidos (estágio %u)", i);
+				return HAL_BLE_ERROR_INVALID;
+			}
+		}
+		
+		// Prepara parâmetros
+		uint32_t options = 0;
+		if (adv_params->connectable) 
+		{
+			options |= BT_LE_ADV_OPT_CONN;
+		}
+		if (adv_params->use_identity) 
+		{
+			options |= BT_LE_ADV_OPT_USE_IDENTITY;
+		}
+		
+		adv_options = options;
+		memcpy(adv_schedule, stages, stage_count * sizeof(stages[0]));
+		adv_stage_count = stage_count;
+		
+		LOG_DBG("Parâmetros de advertising configurados: %u estágio(s), %u-%u ms",
+		        stage_count, stages[0].interval_min_ms, stages[0].interval_max_ms);
+	} 
+	else 
+	{
+		// Usa parâmetros padrão
+		adv_options = BT_LE_ADV_OPT_CONN | BT_LE_ADV_OPT_USE_IDENTITY;
+		adv_schedule[0].interval_min_ms = DEFAULT_ADV_INTERVAL_MIN_MS;
+		adv_schedule[0].interval_max_ms = DEFAULT_ADV_INTERVAL_MAX_MS;
+		adv_schedule[0].duration_s = 0;
+		adv_stage_count = 1;
+	}
+	
+	// Inicia advertising via work item (assíncrono)
+	k_work_submit(&adv_work);
+	
+	return HAL_BLE_SUCCESS;
+}
+
+int hal_ble_stop_advertising(void)
+{
+	if (!initialized) 
+	{
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	if (current_state != HAL_BLE_STATE_ADVERTISING) 
+	{
+		LOG_WRN("Advertising não está ativo");
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	k_work_cancel_delayable(&adv_stage_work);
+	
+	int err = conn_adv_stop();
+	if (err) 
+	{
+		LOG_ERR("Falha ao parar advertising (err %d)", err);
+		return HAL_BLE_ERROR_FAILED;
+	}
+	
+	current_state = (conn_count > 0) ? HAL_BLE_STATE_CONNECTED : HAL_BLE_STATE_READY;
+	LOG_INF("Advertising parado");
+	
+	// Notifica aplicação
+	if (user_callbacks.adv_stopped) 
+	{
+		user_callbacks.adv_stopped();
+	}
+	
+	return HAL_BLE_SUCCESS;
+}
+
+int hal_ble_disconnect(void)
+{
+	if (!initialized) 
+	{
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	if (conn_count == 0) 
+	{
+		LOG_ERR("Não há conexão ativa");
+		return HAL_BLE_ERROR_NOT_CONNECTED;
+	}
+	
+	int ret = HAL_BLE_SUCCESS;
+	
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
+	{
+		if (!conn_ctx[i].conn) 
+		{
+			continue;
+		}
+		
+		int err = bt_conn_disconnect(conn_ctx[i].conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
+		if (err) 
+		{
+			LOG_ERR("Falha ao desconectar conexão %u (err %d)", i, err);
+			ret = HAL_BLE_ERROR_FAILED;
+		}
+	}
+	
+	LOG_INF("Desconexão solicitada");
+	return ret;
+}
+
+hal_ble_state_t hal_ble_get_state(void)
+{
+	return current_state;
+}
+
+bool hal_ble_is_connected(void)
+{
+	return conn_count > 0;
+}
+
+uint8_t hal_ble_get_conn_count(void)
+{
+	return conn_count;
+}
+
+int hal_ble_set_conn_profile(hal_ble_conn_profile_t profile)
+{
+	if (!initialized) 
+	{
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	if (profile >= ARRAY_SIZE(conn_profiles)) 
+	{
+		LOG_ERR("Perfil de conexão inválido: %d", profile);
+		return HAL_BLE_ERROR_INVALID;
+	}
+	
+	if (profile == conn_profile) 
+	{
+		return HAL_BLE_SUCCESS;
+	}
+	
+	conn_profile = profile;
+	
+	// O perfil ALERT liga o piso de potência do alarme
+	txp_refresh();
+	
+	// Só a conexão principal segue o perfil da aplicação
+	struct ble_conn_ctx *ctx = conn_ctx_primary();
+	
+	if (!ctx) 
+	{
+		return HAL_BLE_SUCCESS;
+	}
+	
+	ctx->param_retries = CONFIG_HAL_BLE_CONN_PARAM_RETRIES;
+	
+	// ALERT não espera a acomodação: a resposta do buzzer tem prioridade
+	if (ctx->settled || profile == HAL_BLE_CONN_PROFILE_ALERT) 
+	{
+		k_work_reschedule(&ctx->param_work, K_NO_WAIT);
+	}
+	
+	return HAL_BLE_SUCCESS;
+}
+
+hal_ble_conn_profile_t hal_ble_get_conn_profile(void)
+{
+	return conn_profile;
+}
+
+int hal_ble_get_conn_info(hal_ble_conn_info_t *conn_info)
+{
+	if (!conn_info) 
+	{
+		return HAL_BLE_ERROR_INVALID;
+	}
+	
+	struct ble_conn_ctx *ctx = conn_ctx_primary();
+	
+	if (!ctx) 
+	{
+		return HAL_BLE_ERROR_NOT_CONNECTED;
+	}
+	
+	conn_info_fill(ctx, conn_info);
+	
+	return HAL_BLE_SUCCESS;
+}
+
+int hal_ble_set_rssi_interval(uint32_t interval_ms)
+{
+	if (!initialized) 
+	{
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	if (interval_ms > 0 && interval_ms < RSSI_INTERVAL_MIN_MS) 
+	{
+		LOG_ERR("Intervalo de RSSI inválido: %u ms (mínimo %d ms)", interval_ms,
+		        RSSI_INTERVAL_MIN_MS);
+		return HAL_BLE_ERROR_INVALID;
+	}
+	
+	rssi_interval_ms = interval_ms;
+	
+	// Com a perda de percurso no controlador, o novo intervalo vale para o
+	// retorno à amostragem de RSSI
+	struct ble_conn_ctx *ctx = conn_ctx_primary();
+	
+	if (!ctx || ctx->path_loss_active) 
+	{
+		return HAL_BLE_SUCCESS;
+	}
+	
+	if (interval_ms == 0) 
+	{
+		k_work_cancel_delayable(&ctx->rssi_work);
+	}
+	else 
+	{
+		k_work_reschedule(&ctx->rssi_work, K_MSEC(interval_ms));
+	}
+	
+	return HAL_BLE_SUCCESS;
+}
+
+int hal_ble_get_rssi(hal_ble_rssi_sample_t *sample)
+{
+	if (!sample) 
+	{
+		return HAL_BLE_ERROR_INVALID;
+	}
+	
+	if (!hal_ble_is_connected()) 
+	{
+		return HAL_BLE_ERROR_NOT_CONNECTED;
+	}
+	
+	int ret = HAL_BLE_SUCCESS;
+	k_spinlock_key_t key = k_spin_lock(&rssi_lock);
+	
+	if (rssi_valid) 
+	{
+		*sample = rssi_latest;
+	}
+	else 
+	{
+		ret = HAL_BLE_ERROR_STATE;
+	}
+	
+	k_spin_unlock(&rssi_lock, key);
+	
+	return ret;
+}
+
+int hal_ble_rssi_pop(hal_ble_rssi_sample_t *sample)
+{
+	if (!sample) 
+	{
+		return HAL_BLE_ERROR_INVALID;
+	}
+	
+	uint32_t tail = (uint32_t)atomic_get(&rssi_tail);
+	uint32_t head = (uint32_t)atomic_get(&rssi_head);
+	
+	if (tail == head) 
+	{
+		return HAL_BLE_ERROR_STATE;
+	}
+	
+	*sample = rssi_ring[tail & RSSI_RING_MASK];
+	
+	// Libera a posição só depois de copiada
+	atomic_inc(&rssi_tail);
+	
+	return HAL_BLE_SUCCESS;
+}
+
+int hal_ble_register_rssi_cb(hal_ble_rssi_cb_t cb)
 {
-	if (err) 
+	if (cb == NULL) 
 	{
-		LOG_ERR("Conexão falhou (err %u)", err);
-		
-		// Reinicia advertising
-		k_work_submit(&adv_work);
-		return;
+		LOG_ERR("Callback de RSSI é NULL");
+		return HAL_BLE_ERROR_INVALID;
 	}
 	
-	// Armazena referência da conexão
-	if (current_conn) 
+	if (rssi_cb_count >= MAX_RSSI_CBS) 
 	{
-		bt_conn_unref(current_conn);
+		LOG_ERR("Limite de callbacks de RSSI atingido");
+		return HAL_BLE_ERROR_STATE;
 	}
-	current_conn = bt_conn_ref(conn);
-	current_state = HAL_BLE_STATE_CONNECTED;
 	
-	// Lê informações da conexão
-	struct bt_conn_info info;
-	if (bt_conn_get_info(conn, &info) == 0) 
+	rssi_cbs[rssi_cb_count++] = cb;
+	
+	return HAL_BLE_SUCCESS;
+}
+
+int hal_ble_set_path_loss_monitor(const hal_ble_path_loss_params_t *params,
+                                  hal_ble_path_loss_cb_t cb)
+{
+	if (!initialized) 
 	{
-		LOG_INF("Conectado - Intervalo: %u, Latência: %u, Timeout: %u", info.le.interval, info.le.latency, info.le.timeout);
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
 	}
 	
-	// Notifica aplicação
-	if (user_callbacks.connected) 
+	if (cb) 
 	{
-		hal_ble_conn_info_t conn_info = {0};
-		
-		if (bt_conn_get_info(conn, &info) == 0) 
+		if (!params || params->near_db >= params->far_db) 
 		{
-			conn_info.interval_ms = info.le.interval * 1250 / 1000; // 1.25ms por unidade
-			conn_info.latency = info.le.latency;
-			conn_info.timeout_ms = info.le.timeout * 10; // 10ms por unidade
+			LOG_ERR("Limiares de perda de percurso inválidos");
+			return HAL_BLE_ERROR_INVALID;
 		}
 		
-		user_callbacks.connected(&conn_info);
+		path_loss_params = *params;
 	}
-}
-
-/**
- * @brief Callback chamado quando uma conexão é encerrada
- */
-static void on_disconnected(struct bt_conn *conn, uint8_t reason)
-{
-	LOG_INF("Desconectado (motivo %u)", reason);
 	
-	// Libera referência da conexão
-	if (current_conn) 
-	{
-		bt_conn_unref(current_conn);
-		current_conn = NULL;
-	}
+	path_loss_cb = cb;
 	
-	current_state = HAL_BLE_STATE_READY;
+	struct ble_conn_ctx *ctx = conn_ctx_primary();
 	
-	// Notifica aplicação
-	if (user_callbacks.disconnected) 
+	if (ctx) 
 	{
-		user_callbacks.disconnected(reason);
+		k_work_submit(&ctx->monitor_work);
 	}
+	
+	return HAL_BLE_SUCCESS;
 }
 
-/**
- * @brief Callback chamado quando a conexão é reciclada
- */
-static void on_recycled(void)
+bool hal_ble_is_path_loss_active(void)
 {
-	LOG_DBG("Conexão reciclada - reiniciando advertising");
+	struct ble_conn_ctx *ctx = conn_ctx_primary();
 	
-	// Reinicia advertising
-	k_work_submit(&adv_work);
+	return ctx != NULL && ctx->path_loss_active;
 }
 
-// Estrutura de callbacks de conexão
-static struct bt_conn_cb conn_callbacks = {
-	.connected = on_connected,
-	.disconnected = on_disconnected,
-	.recycled = on_recycled,
-};
-
-/*******************************************************************************
- * FUNÇÕES PRIVADAS - ADVERTISING
- ******************************************************************************/
-
-/**
- * @brief Handler do work item para iniciar advertising
- */
-static void adv_work_handler(struct k_work *work)
+int hal_ble_set_bulk_transfer(bool active)
 {
-	if (current_state == HAL_BLE_STATE_CONNECTED) 
+	if (!initialized) 
 	{
-		LOG_WRN("Já conectado, não inicia advertising");
-		return;
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
 	}
 	
-	// Usa parâmetros padrão se não foram configurados
-	const struct bt_le_adv_param *param = adv_param;
-	if (!param) 
+	atomic_val_t prev;
+	
+	if (active) 
 	{
-		param = BT_LE_ADV_PARAM(
-			(BT_LE_ADV_OPT_CONN | BT_LE_ADV_OPT_USE_IDENTITY),
-			MS_TO_BLE_UNITS(DEFAULT_ADV_INTERVAL_MIN_MS),
-			MS_TO_BLE_UNITS(DEFAULT_ADV_INTERVAL_MAX_MS),
-			NULL
-		);
+		prev = atomic_inc(&bulk_pending);
 	}
-	
-	// Inicia advertising
-	int err = bt_le_adv_start(param, ad_data, ad_data_count, sd_data, sd_data_count);
-	if (err) 
+	else 
 	{
-		LOG_ERR("Advertising falhou (err %d)", err);
-		return;
+		// Não deixa o contador ficar negativo
+		do 
+		{
+			prev = atomic_get(&bulk_pending);
+			if (prev == 0) 
+			{
+				return HAL_BLE_ERROR_STATE;
+			}
+		} while (!atomic_cas(&bulk_pending, prev, prev - 1));
 	}
 	
-	current_state = HAL_BLE_STATE_ADVERTISING;
-	LOG_INF("Advertising iniciado");
-	
-	// Notifica aplicação
-	if (user_callbacks.adv_started) 
+#if defined(CONFIG_HAL_BLE_PHY_MANAGER)
+	// Só a primeira transferência e o fim da última mudam a política
+	if ((active && prev == 0) || (!active && prev == 1)) 
 	{
-		user_callbacks.adv_started();
+		phy_policy_refresh();
 	}
+#endif
+	
+	return HAL_BLE_SUCCESS;
 }
 
-/**
- * @brief Prepara os dados de advertising
- */
-static void prepare_adv_data(void)
+int hal_ble_get_phy_stats(hal_ble_phy_stats_t *stats)
 {
-	size_t name_len = strlen(device_name);
+	if (!stats) 
+	{
+		return HAL_BLE_ERROR_INVALID;
+	}
 	
-	// Advertising data
-	ad_data_count = 0;
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key = k_spin_lock(&phy_lock);
 	
-	// Flags
-	ad_data[ad_data_count].type = BT_DATA_FLAGS;
-	ad_data[ad_data_count].data_len = 1;
-	static const uint8_t flags = BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR;
-	ad_data[ad_data_count].data = &flags;
-	ad_data_count++;
+	*stats = phy_stats;
 	
-	// Nome do dispositivo
-	if (name_len > 0) 
+	// Trechos em andamento das conexões ativas
+	for (uint8_t i = 0; i < MAX_CONN; i++) 
 	{
-		ad_data[ad_data_count].type = BT_DATA_NAME_COMPLETE;
-		ad_data[ad_data_count].data_len = name_len;
-		ad_data[ad_data_count].data = (const uint8_t *)device_name;
-		ad_data_count++;
+		if (conn_ctx[i].conn) 
+		{
+			stats->time_ms[conn_ctx[i].phy] += (uint32_t)(now - conn_ctx[i].phy_since_ms);
+		}
 	}
 	
-	// Scan response data
-	sd_data_count = 0;
-	
-	// UUID do serviço customizado Buzzer Service (declaração estática)
-	static const struct bt_uuid_128 buzzer_uuid = BT_UUID_INIT_128(BT_UUID_BUZZER_SERVICE_VAL);
+	k_spin_unlock(&phy_lock, key);
 	
-	sd_data[sd_data_count].type = BT_DATA_UUID128_ALL;
-	sd_data[sd_data_count].data_len = 16;
-	sd_data[sd_data_count].data = buzzer_uuid.val;
-	sd_data_count++;
+	return HAL_BLE_SUCCESS;
 }
 
-/*******************************************************************************
- * API PÚBLICA
- ******************************************************************************/
-
-int hal_ble_init(const char *device_name_param, const hal_ble_callbacks_t *callbacks)
+int hal_ble_set_adv_status(const hal_ble_adv_status_t *status)
 {
-	if (initialized) 
+	if (!initialized) 
 	{
-		LOG_WRN("HAL BLE já inicializado");
-		return HAL_BLE_SUCCESS;
+		return HAL_BLE_ERROR_STATE;
 	}
 	
-	// Valida parâmetros
-	if (!device_name_param) 
+	if (!status ||
+	    (status->battery_pct > 100 && status->battery_pct != HAL_BLE_BATTERY_UNKNOWN)) 
 	{
-		LOG_ERR("Nome do dispositivo não pode ser NULL");
 		return HAL_BLE_ERROR_INVALID;
 	}
 	
-	size_t name_len = strlen(device_name_param);
-	if (name_len > MAX_DEVICE_NAME_LEN) 
+	uint8_t flags = status->alarm_active ? ADV_STATUS_FLAG_ALARM : 0;
+	bool changed = false;
+	
+	if (status->alarm_active != alarm_active) 
 	{
-		LOG_ERR("Nome do dispositivo muito longo (max %d caracteres)", MAX_DEVICE_NAME_LEN);
-		return HAL_BLE_ERROR_INVALID;
+		alarm_active = status->alarm_active;
+		txp_refresh();
 	}
 	
-	// Armazena nome do dispositivo
-	strncpy(device_name, device_name_param, MAX_DEVICE_NAME_LEN);
-	device_name[MAX_DEVICE_NAME_LEN] = '\0';
-	
-	// Armazena callbacks
-	if (callbacks) 
+	k_spinlock_key_t key = k_spin_lock(&adv_status_lock);
+	if (adv_status.battery_pct != status->battery_pct || adv_status.flags != flags) 
 	{
-		user_callbacks = *callbacks;
+		adv_status.battery_pct = status->battery_pct;
+		adv_status.flags = flags;
+		adv_status.seq++;
+		changed = true;
 	}
+	k_spin_unlock(&adv_status_lock, key);
 	
-	// Habilita Bluetooth
-	int err = bt_enable(NULL);
-	if (err) 
+	if (changed) 
 	{
-		LOG_ERR("Falha ao habilitar Bluetooth (err %d)", err);
-		return HAL_BLE_ERROR_INIT;
+		k_work_submit(&adv_update_work);
 	}
 	
-	LOG_INF("Bluetooth habilitado");
-	
-	// Registra callbacks de conexão
-	bt_conn_cb_register(&conn_callbacks);
-	
-	// Inicializa serviço customizado MY LBS
-	// (callbacks do serviço serão registrados pela aplicação)
-	
-	// Prepara dados de advertising
-	prepare_adv_data();
-	
-	// Inicializa work item para advertising
-	k_work_init(&adv_work, adv_work_handler);
-	
-	// Estado pronto
-	current_state = HAL_BLE_STATE_READY;
-	initialized = true;
-	
-	LOG_INF("HAL BLE inicializado - Device: %s", device_name);
 	return HAL_BLE_SUCCESS;
 }
 
-int hal_ble_start_advertising(const hal_ble_adv_params_t *adv_params)
+int hal_ble_start_periodic_adv(uint32_t interval_ms)
 {
 	if (!initialized) 
 	{
@@ -333,68 +2895,32 @@ int hal_ble_start_advertising(const hal_ble_adv_params_t *adv_params)
 		return HAL_BLE_ERROR_STATE;
 	}
 	
-	if (current_state == HAL_BLE_STATE_CONNECTED) 
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+	if (interval_ms == 0) 
 	{
-		LOG_WRN("Já conectado, não pode iniciar advertising");
-		return HAL_BLE_ERROR_STATE;
+		interval_ms = CONFIG_HAL_BLE_PERIODIC_ADV_INTERVAL_MS;
 	}
 	
-	if (current_state == HAL_BLE_STATE_ADVERTISING) 
+	if (interval_ms < PER_ADV_INTERVAL_MIN_MS || interval_ms > PER_ADV_INTERVAL_MAX_MS) 
 	{
-		LOG_WRN("Advertising já está ativo");
-		return HAL_BLE_SUCCESS;
+		LOG_ERR("Intervalo do advertising periódico inválido: %u ms", interval_ms);
+		return HAL_BLE_ERROR_INVALID;
 	}
 	
-	// Configura parâmetros de advertising
-	if (adv_params) 
-	{
-		// Valida parâmetros
-		if (adv_params->interval_min_ms < ADV_INTERVAL_MIN_MS ||
-		    adv_params->interval_min_ms > ADV_INTERVAL_MAX_MS ||
-		    adv_params->interval_max_ms < ADV_INTERVAL_MIN_MS ||
-		    adv_params->interval_max_ms > ADV_INTERVAL_MAX_MS ||
-		    adv_params->interval_min_ms > adv_params->interval_max_ms) {
-			LOG_ERR("Parâmetros de advertising inválidos");
-			return HAL_BLE_ERROR_INVALID;
-		}
-		
-		// Prepara parâmetros
-		uint32_t options = 0;
-		if (adv_params->connectable) 
-		{
-			options |= BT_LE_ADV_OPT_CONN;
-		}
-		if (adv_params->use_identity) 
-		{
-			options |= BT_LE_ADV_OPT_USE_IDENTITY;
-		}
-		
-		adv_param_storage.id = 0;
-		adv_param_storage.sid = 0;
-		adv_param_storage.secondary_max_skip = 0;
-		adv_param_storage.options = options;
-		adv_param_storage.interval_min = MS_TO_BLE_UNITS(adv_params->interval_min_ms);
-		adv_param_storage.interval_max = MS_TO_BLE_UNITS(adv_params->interval_max_ms);
-		adv_param_storage.peer = NULL;
-		
-		adv_param = &adv_param_storage;
-		
-		LOG_DBG("Parâmetros de advertising configurados: %u-%u ms",
-		        adv_params->interval_min_ms, adv_params->interval_max_ms);
-	} 
-	else 
-	{
-		// Usa parâmetros padrão
-		adv_param = NULL;
-	}
+	per_adv_interval_ms = interval_ms;
+	per_adv_enable = true;
 	
-	// Inicia advertising via work item (assíncrono)
-	k_work_submit(&adv_work);
+	// Cria e inicia o conjunto via work item (assíncrono)
+	k_work_submit(&per_adv_work);
 	
 	return HAL_BLE_SUCCESS;
+#else
+	LOG_WRN("Advertising periódico desabilitado (CONFIG_HAL_BLE_PERIODIC_ADV)");
+	return HAL_BLE_ERROR_STATE;
+#endif
 }
 
-int hal_ble_stop_advertising(void)
+int hal_ble_stop_periodic_adv(void)
 {
 	if (!initialized) 
 	{
@@ -402,32 +2928,70 @@ int hal_ble_stop_advertising(void)
 		return HAL_BLE_ERROR_STATE;
 	}
 	
-	if (current_state != HAL_BLE_STATE_ADVERTISING) 
+#if defined(CONFIG_HAL_BLE_PERIODIC_ADV)
+	per_adv_enable = false;
+	k_work_submit(&per_adv_work);
+	
+	return HAL_BLE_SUCCESS;
+#else
+	return HAL_BLE_ERROR_STATE;
+#endif
+}
+
+int hal_ble_start_beacon(const hal_ble_beacon_params_t *params)
+{
+	if (!initialized) 
 	{
-		LOG_WRN("Advertising não está ativo");
+		LOG_ERR("HAL BLE não inicializado");
 		return HAL_BLE_ERROR_STATE;
 	}
 	
-	int err = bt_le_adv_stop();
-	if (err) 
+#if defined(CONFIG_HAL_BLE_BEACON)
+	if (params) 
 	{
-		LOG_ERR("Falha ao parar advertising (err %d)", err);
-		return HAL_BLE_ERROR_FAILED;
+		if (params->interval_ms < ADV_INTERVAL_MIN_MS ||
+		    params->interval_ms > ADV_INTERVAL_MAX_MS ||
+		    params->tx_power_dbm < TX_POWER_MIN_DBM ||
+		    params->tx_power_dbm > TX_POWER_MAX_DBM) 
+		{
+			LOG_ERR("Parâmetros do beacon inválidos");
+			return HAL_BLE_ERROR_INVALID;
+		}
+		
+		beacon_params = *params;
 	}
 	
-	current_state = HAL_BLE_STATE_READY;
-	LOG_INF("Advertising parado");
+	beacon_enable = true;
 	
-	// Notifica aplicação
-	if (user_callbacks.adv_stopped) 
+	// Cria e inicia o conjunto via work item (assíncrono)
+	k_work_submit(&beacon_work);
+	
+	return HAL_BLE_SUCCESS;
+#else
+	LOG_WRN("Beacon desabilitado (CONFIG_HAL_BLE_BEACON)");
+	return HAL_BLE_ERROR_STATE;
+#endif
+}
+
+int hal_ble_stop_beacon(void)
+{
+	if (!initialized) 
 	{
-		user_callbacks.adv_stopped();
+		LOG_ERR("HAL BLE não inicializado");
+		return HAL_BLE_ERROR_STATE;
 	}
 	
+#if defined(CONFIG_HAL_BLE_BEACON)
+	beacon_enable = false;
+	k_work_submit(&beacon_work);
+	
 	return HAL_BLE_SUCCESS;
+#else
+	return HAL_BLE_ERROR_STATE;
+#endif
 }
 
-int hal_ble_disconnect(void)
+int hal_ble_set_adv_tx_power(hal_ble_adv_set_t set, int8_t tx_power_dbm)
 {
 	if (!initialized) 
 	{
@@ -435,36 +2999,25 @@ int hal_ble_disconnect(void)
 		return HAL_BLE_ERROR_STATE;
 	}
 	
-	if (!current_conn) 
+	if (tx_power_dbm < TX_POWER_MIN_DBM || tx_power_dbm > TX_POWER_MAX_DBM) 
 	{
-		LOG_ERR("Não há conexão ativa");
-		return HAL_BLE_ERROR_NOT_CONNECTED;
+		return HAL_BLE_ERROR_INVALID;
 	}
 	
-	int err = bt_conn_disconnect(current_conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
-
-	if (err) 
-	{
-		LOG_ERR("Falha ao desconectar (err %d)", err);
-		return HAL_BLE_ERROR_FAILED;
+	switch (set) {
+	case HAL_BLE_ADV_SET_CONN:
+		conn_adv_tx_power = tx_power_dbm;
+		break;
+#if defined(CONFIG_HAL_BLE_BEACON)
+	case HAL_BLE_ADV_SET_BEACON:
+		beacon_params.tx_power_dbm = tx_power_dbm;
+		break;
+#endif
+	default:
+		return HAL_BLE_ERROR_INVALID;
 	}
 	
-	LOG_INF("Desconexão solicitada");
+	k_work_submit(&adv_tx_work);
+	
 	return HAL_BLE_SUCCESS;
 }
-
-hal_ble_state_t hal_ble_get_state(void)
-{
-	return current_state;
-}
-
-bool hal_ble_is_connected(void)
-{
-	return (current_state == HAL_BLE_STATE_CONNECTED && current_conn != NULL);
-}
-
-
-
-
-
-
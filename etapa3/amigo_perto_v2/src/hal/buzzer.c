@@ -15,6 +15,8 @@
  * - 3 níveis de intensidade (LOW=25%, MEDIUM=50%, HIGH=100%)
  * - Thread dedicada para temporização
  * - Controle thread-safe com semáforos
+ * - Callback de transição de carga (PWM ligado/desligado)
+ * - Arbitragem das fontes de alarme (alarme toca enquanto houver pedido)
  * 
  * Copyright (c) 2025
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
@@ -67,6 +69,18 @@ static uint8_t current_intensity = HAL_BUZZER_INTENSITY_MEDIUM;
 static struct k_work_delayable pattern_intermittent_work;
 static bool pattern_intermittent_active = false;
 
+// Callback de transição de carga do PWM (load_active só muda na work queue)
+static hal_buzzer_load_cb_t load_cb = NULL;
+static bool load_active = false;
+
+// Callback de início e fim do alarme
+static hal_buzzer_state_cb_t state_cb = NULL;
+
+// Intensidade pedida por fonte de alarme (0 = fonte inativa); o mutex
+// serializa a atualização e a aplicação do resultado ao padrão
+static uint8_t alarm_requests[HAL_BUZZER_SOURCE_COUNT];
+static K_MUTEX_DEFINE(alarm_lock);
+
 /*******************************************************************************
  * FUNÇÕES PRIVADAS - CONTROLE PWM
  ******************************************************************************/
@@ -106,6 +120,19 @@ static int pwm_set_intensity(uint8_t intensity)
 		return ret;
 	}
 	
+	// Avisa transições de carga (PWM conduzindo ou não)
+	bool active = (pulse_ns > 0);
+	
+	if (active != load_active) 
+	{
+		load_active = active;
+		
+		if (load_cb) 
+		{
+			load_cb(active);
+		}
+	}
+	
 	return 0;
 }
 
@@ -126,6 +153,8 @@ static void pattern_intermittent_handler(struct k_work *work)
 	
 	if (!pattern_intermittent_active) 
 	{
+		// Parada pedida por stop_intermittent(): desliga aqui, na work queue
+		state = false;
 		pwm_set_intensity(0);
 		return;
 	}
@@ -155,12 +184,17 @@ static void pattern_intermittent_handler(struct k_work *work)
 
 // Funções privadas - controle de padrão intermitente
 
-
+/**
+ * @brief Para o padrão intermitente
+ * 
+ * O PWM não é desligado no contexto de quem chama (ex.: thread RX do BT):
+ * o handler é reagendado imediatamente e desliga o PWM na work queue, de
+ * modo que o callback de carga e load_active só rodam nela.
+ */
 static void stop_intermittent(void)
 {
 	pattern_intermittent_active = false;
-	k_work_cancel_delayable(&pattern_intermittent_work);
-	pwm_set_intensity(0);
+	k_work_reschedule(&pattern_intermittent_work, K_NO_WAIT);
 }
 
 /**
@@ -183,6 +217,8 @@ int hal_buzzer_set_intermittent(bool active, uint8_t intensity)
 		return HAL_BUZZER_ERROR_INVALID;
 	}
 
+	bool was_active = pattern_intermittent_active;
+
 	if (active) 
 	{
 		current_intensity = intensity;
@@ -196,6 +232,12 @@ int hal_buzzer_set_intermittent(bool active, uint8_t intensity)
 		LOG_INF("Buzzer intermitente DESATIVADO");
 	}
 
+	// Avisa apenas o início e o fim do alarme (não as trocas de intensidade)
+	if (active != was_active && state_cb) 
+	{
+		state_cb(active);
+	}
+
 	return HAL_BUZZER_SUCCESS;
 }
 
@@ -207,6 +249,68 @@ int hal_buzzer_set_intermittent(bool active, uint8_t intensity)
 
 // API pública
 
+int hal_buzzer_set_alarm(hal_buzzer_source_t source, bool active, uint8_t intensity)
+{
+	if (!initialized) 
+	{
+		LOG_ERR("HAL Buzzer não inicializado");
+		return HAL_BUZZER_ERROR_STATE;
+	}
+	
+	if (source >= HAL_BUZZER_SOURCE_COUNT || 
+	    (active && (intensity == 0 || intensity > 100))) 
+	{
+		LOG_ERR("Pedido de alarme inválido: fonte %d, intensidade %d", source, intensity);
+		return HAL_BUZZER_ERROR_INVALID;
+	}
+	
+	k_mutex_lock(&alarm_lock, K_FOREVER);
+	
+	alarm_requests[source] = active ? intensity : 0;
+	
+	// Maior intensidade entre as fontes ativas (0 = nenhuma)
+	uint8_t max_intensity = 0;
+	
+	for (int i = 0; i < HAL_BUZZER_SOURCE_COUNT; i++) 
+	{
+		max_intensity = MAX(max_intensity, alarm_requests[i]);
+	}
+	
+	LOG_DBG("Alarme: fonte %d %s, intensidade resultante %d%%", source,
+	        active ? "pede" : "libera", max_intensity);
+	
+	// Sem mudança no padrão quando a fonte já estava liberada e nada toca
+	int ret = HAL_BUZZER_SUCCESS;
+	
+	if (max_intensity > 0 || pattern_intermittent_active) 
+	{
+		ret = hal_buzzer_set_intermittent(max_intensity > 0, max_intensity);
+	}
+	
+	k_mutex_unlock(&alarm_lock);
+	
+	return ret;
+}
+
+int hal_buzzer_set_load_callback(hal_buzzer_load_cb_t cb)
+{
+	load_cb = cb;
+	
+	return HAL_BUZZER_SUCCESS;
+}
+
+int hal_buzzer_set_state_callback(hal_buzzer_state_cb_t cb)
+{
+	state_cb = cb;
+	
+	return HAL_BUZZER_SUCCESS;
+}
+
+bool hal_buzzer_is_active(void)
+{
+	return pattern_intermittent_active;
+}
+
 int hal_buzzer_init(void)
 {
 	if (initialized) 
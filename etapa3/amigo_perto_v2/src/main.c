@@ -12,7 +12,10 @@
  * - Advertising BLE para descoberta do dispositivo
  * - Serviço GATT Buzzer customizado (controle remoto de alarme)
  * - Serviço GATT Battery padrão (monitoramento de bateria CR2032)
+ * - Link Loss Service padrão (alarme local na perda do enlace)
+ * - Immediate Alert Service padrão (alarme disparado pelo app, sem resposta)
  * - LEDs de status (verde=conexão, azul=advertising)
+ * - Dome virtual: alarme local quando o cão se afasta (RSSI da conexão)
  * - HAL modular (Buzzer, Battery, BLE)
  * 
  * Arquitetura:
@@ -36,11 +39,18 @@
 // Hardware Abstraction Layer
 #include "hal/buzzer.h"
 #include "hal/battery.h"
+#include "hal/battery_history.h"
+#include "hal/battery_forecast.h"
 #include "hal/ble.h"
 
+// Motor de proximidade (dome virtual)
+#include "proximity.h"
+
 // GATT Services
 #include "gatt/buzzer_service.h"
 #include "gatt/battery_service.h"
+#include "gatt/link_loss_service.h"
+#include "gatt/immediate_alert_service.h"
 
 // Registra o módulo de logging com o nome "MainApp" e nível INFO
 LOG_MODULE_REGISTER(MainApp, LOG_LEVEL_INF);
@@ -64,6 +74,18 @@ static const struct gpio_dt_spec led_azul = GPIO_DT_SPEC_GET(LED_AZUL_NODE, gpio
 #error "Unsupported board: ledazul devicetree alias is not defined"
 #endif
 
+// Tempo de acomodação da carga do buzzer antes da medição da bateria
+#define BUZZER_LOAD_SETTLE_MS 20
+
+// Cronograma de advertising: intervalo curto logo após o boot ou uma
+// desconexão (reconexão rápida quando o dono volta ao alcance), depois
+// intervalos maiores para economizar bateria
+static const hal_ble_adv_stage_t adv_schedule[] = {
+	{ .interval_min_ms = 20,   .interval_max_ms = 30,   .duration_s = 30 },
+	{ .interval_min_ms = 500,  .interval_max_ms = 500,  .duration_s = 300 },
+	{ .interval_min_ms = 2000, .interval_max_ms = 2000, .duration_s = 0 },
+};
+
 /**
  * Callbacks HAL BLE - Eventos de conexão Bluetooth
  */
@@ -73,7 +95,8 @@ static const struct gpio_dt_spec led_azul = GPIO_DT_SPEC_GET(LED_AZUL_NODE, gpio
  */
 static void on_ble_connected(const hal_ble_conn_info_t *conn_info)
 {
-	LOG_INF("Dispositivo conectado");
+	LOG_INF("Dispositivo conectado (conexão %u%s, %u ativa(s))", conn_info->conn_id,
+	        conn_info->primary ? ", principal" : "", hal_ble_get_conn_count());
 	LOG_INF("  Intervalo: %u ms", conn_info->interval_ms);
 	LOG_INF("  Latência: %u", conn_info->latency);
 	LOG_INF("  Timeout: %u ms", conn_info->timeout_ms);
@@ -88,12 +111,46 @@ static void on_ble_connected(const hal_ble_conn_info_t *conn_info)
 static void on_ble_disconnected(uint8_t reason)
 {
 	LOG_INF("Dispositivo desconectado (motivo %u)", reason);
-	// Desativa o buzzer intermitente ao desconectar
-	hal_buzzer_set_intermittent(false, 0);
+	// Outro celular segue conectado: o dome continua por ele
+	if (hal_ble_is_connected()) 
+	{
+		return;
+	}
+	// O buzzer é decidido pelo Link Loss Service: alerta na perda de
+	// enlace, desligado em uma desconexão solicitada
+	hal_ble_set_conn_profile(HAL_BLE_CONN_PROFILE_IDLE);
+	// O RSSI da próxima conexão recomeça os filtros de proximidade
+	proximity_reset();
 	// Apaga o LED verde ao desconectar
 	gpio_pin_set_dt(&led_verde, 0);
 }
 
+/**
+ * Callback chamado quando o central altera os parâmetros da conexão
+ */
+static void on_ble_conn_params_updated(const hal_ble_conn_info_t *conn_info)
+{
+	LOG_INF("Parâmetros de conexão (perfil %d): %u ms, latência %u, timeout %u ms",
+	        conn_info->profile, conn_info->interval_ms, conn_info->latency,
+	        conn_info->timeout_ms);
+}
+
+/**
+ * Callback chamado quando o PHY de uma conexão muda
+ */
+static void on_ble_phy_updated(const hal_ble_phy_info_t *phy_info)
+{
+	static const char *const phy_names[HAL_BLE_PHY_COUNT] = {
+		[HAL_BLE_PHY_1M] = "1M",
+		[HAL_BLE_PHY_2M] = "2M",
+		[HAL_BLE_PHY_CODED] = "Coded",
+	};
+	
+	LOG_INF("Conexão %u: PHY %s -> %s (%u ms no anterior)", phy_info->conn_id,
+	        phy_names[phy_info->prev_phy], phy_names[phy_info->phy],
+	        phy_info->prev_duration_ms);
+}
+
 /**
  * Callback chamado quando advertising é iniciado
  */
@@ -120,8 +177,87 @@ static const hal_ble_callbacks_t ble_callbacks = {
 	.disconnected = on_ble_disconnected,
 	.adv_started = on_ble_adv_started,
 	.adv_stopped = on_ble_adv_stopped,
+	.conn_params_updated = on_ble_conn_params_updated,
+	.phy_updated = on_ble_phy_updated,
 };
 
+/**
+ * Callback chamado quando o cão cruza a borda do dome virtual
+ */
+static void on_proximity_zone(proximity_zone_t zone, uint32_t distance_cm)
+{
+	bool outside = (zone == PROXIMITY_ZONE_OUTSIDE);
+	
+	LOG_INF("Dome virtual: %s (%u cm)", outside ? "FORA - alarme" : "DENTRO", distance_cm);
+	
+	// O motor já pediu ou retirou o alarme do dome; intervalo curto
+	// enquanto alguma fonte mantém o buzzer tocando
+	hal_ble_set_conn_profile(hal_buzzer_is_active() ? HAL_BLE_CONN_PROFILE_ALERT :
+	                                                  HAL_BLE_CONN_PROFILE_IDLE);
+}
+
+/**
+ * Callback chamado quando o PWM do buzzer liga ou desliga
+ */
+static void on_buzzer_load(bool active)
+{
+	// Mede a bateria sob a carga do buzzer; a medição só vale se o PWM
+	// seguir ligado até o fim da conversão
+	if (active) 
+	{
+		hal_battery_sample_loaded(BUZZER_LOAD_SETTLE_MS);
+	}
+	else 
+	{
+		hal_battery_load_ended();
+	}
+}
+
+/**
+ * Estado da coleira anunciado no advertising (lido sem conexão)
+ */
+
+// Bateria anunciada (última amostragem periódica)
+static uint8_t adv_battery_pct = HAL_BLE_BATTERY_UNKNOWN;
+
+/**
+ * Anuncia a bateria e o alarme atuais nos dados de fabricante
+ */
+static void adv_status_update(void)
+{
+	const hal_ble_adv_status_t status = {
+		.battery_pct = adv_battery_pct,
+		.alarm_active = hal_buzzer_is_active(),
+	};
+	
+	hal_ble_set_adv_status(&status);
+}
+
+/**
+ * Callback chamado quando o alarme do buzzer liga ou desliga
+ */
+static void on_buzzer_state(bool active)
+{
+	adv_status_update();
+}
+
+/**
+ * Callback chamado a cada amostragem periódica da bateria
+ */
+static void on_battery_sample(const hal_battery_info_t *info)
+{
+	adv_battery_pct = info->percentage;
+	adv_status_update();
+}
+
+/**
+ * Callback chamado quando a bateria entra em estado crítico (comparador POF)
+ */
+static void on_battery_critical(void)
+{
+	LOG_WRN("BATERIA CRÍTICA! Substituir bateria em breve");
+}
+
 /**
  * Callbacks GATT Buzzer Service - Eventos de escrita nas características
  */
@@ -133,11 +269,17 @@ static void on_buzzer_intermittent_write(const bool buzzer_state)
 {
 	LOG_INF("Buzzer Intermitente via BLE: %s", buzzer_state ? "ATIVADO" : "DESATIVADO");
 	int err;
-	err = hal_buzzer_set_intermittent(buzzer_state, HAL_BUZZER_INTENSITY_MEDIUM);
+	err = hal_buzzer_set_alarm(HAL_BUZZER_SOURCE_APP, buzzer_state,
+	                           HAL_BUZZER_INTENSITY_MEDIUM);
 	if (err != HAL_BUZZER_SUCCESS) 
 	{
 		LOG_ERR("Falha ao controlar buzzer intermitente (err %d)", err);
 	}
+	
+	// Intervalo curto enquanto o alarme toca (por qualquer fonte); longo
+	// com latência em repouso
+	hal_ble_set_conn_profile(hal_buzzer_is_active() ? HAL_BLE_CONN_PROFILE_ALERT :
+	                                                  HAL_BLE_CONN_PROFILE_IDLE);
 }
 
 /**
@@ -159,6 +301,87 @@ static void on_battery_read(uint8_t percentage)
 	LOG_INF("Bateria lida via BLE: %d%%", percentage);
 }
 
+/**
+ * Callbacks GATT Link Loss Service - Alerta na perda do enlace
+ */
+
+/**
+ * Converte um nível de alerta do Proximity Profile em intensidade do buzzer
+ */
+static uint8_t alert_level_to_intensity(gatt_alert_level_t level)
+{
+	switch (level) {
+	case GATT_ALERT_LEVEL_MILD:
+		return HAL_BUZZER_INTENSITY_MEDIUM;
+	case GATT_ALERT_LEVEL_HIGH:
+		return HAL_BUZZER_INTENSITY_MAX;
+	default:
+		return HAL_BUZZER_INTENSITY_OFF;
+	}
+}
+
+/**
+ * Callback chamado quando o alerta de perda de enlace começa ou termina
+ */
+static void on_link_loss_alert(gatt_alert_level_t level)
+{
+	bool active = (level != GATT_ALERT_LEVEL_NONE);
+	
+	if (active) 
+	{
+		LOG_WRN("Perda de enlace! Alerta nível %d", level);
+	}
+	
+	int err = hal_buzzer_set_alarm(HAL_BUZZER_SOURCE_LINK_LOSS, active,
+	                               alert_level_to_intensity(level));
+	if (err != HAL_BUZZER_SUCCESS) 
+	{
+		LOG_ERR("Falha ao controlar alerta de perda de enlace (err %d)", err);
+	}
+}
+
+/**
+ * Estrutura de callbacks GATT Link Loss
+ */
+static const struct gatt_link_loss_service_cb link_loss_callbacks = {
+	.alert_cb = on_link_loss_alert,
+};
+
+/**
+ * Callbacks GATT Immediate Alert Service - Alarme disparado pelo app
+ */
+
+/**
+ * Callback chamado quando o app grava um nível de alerta imediato
+ */
+static void on_immediate_alert(gatt_alert_level_t level)
+{
+	bool active = (level != GATT_ALERT_LEVEL_NONE);
+	
+	int err = hal_buzzer_set_alarm(HAL_BUZZER_SOURCE_IMMEDIATE, active,
+	                               alert_level_to_intensity(level));
+	if (err != HAL_BUZZER_SUCCESS) 
+	{
+		LOG_ERR("Falha ao controlar alerta imediato (err %d)", err);
+	}
+	else 
+	{
+		LOG_INF("Alerta imediato via BLE: nível %d", level);
+	}
+	
+	// Como na escrita do buzzer: intervalo curto enquanto o alarme toca,
+	// para que o "parar" do app chegue rápido
+	hal_ble_set_conn_profile(hal_buzzer_is_active() ? HAL_BLE_CONN_PROFILE_ALERT :
+	                                                  HAL_BLE_CONN_PROFILE_IDLE);
+}
+
+/**
+ * Estrutura de callbacks GATT Immediate Alert
+ */
+static const struct gatt_immediate_alert_service_cb immediate_alert_callbacks = {
+	.alert_cb = on_immediate_alert,
+};
+
 /**
  * Estrutura de callbacks GATT Battery
  */
@@ -235,6 +458,26 @@ int main(void)
 
 	LOG_INF("HAL Battery inicializado");
 	
+	// Medição da bateria sob a carga do buzzer
+	hal_buzzer_set_load_callback(on_buzzer_load);
+	
+	// Aviso de bateria crítica orientado a evento
+	hal_battery_register_critical_cb(on_battery_critical);
+	
+	// Histórico de tensão (não essencial: falha apenas registrada)
+	err = hal_battery_history_init();
+	if (err != HAL_BATTERY_SUCCESS) 
+	{
+		LOG_WRN("Histórico de bateria indisponível (err %d)", err);
+	}
+	
+	// Previsão de autonomia (não essencial: falha apenas registrada)
+	err = hal_battery_forecast_init();
+	if (err != HAL_BATTERY_SUCCESS) 
+	{
+		LOG_WRN("Previsão de bateria indisponível (err %d)", err);
+	}
+	
 	// Lê informações da bateria
 	hal_battery_info_t battery_info;
 	err = hal_battery_get_info(&battery_info);
@@ -251,6 +494,8 @@ int main(void)
 		{
 			LOG_WRN("BATERIA CRÍTICA! Substituir bateria em breve");
 		}
+		
+		adv_battery_pct = battery_info.percentage;
 	}
 	
 	// ========== Inicialização HAL BLE ==========
@@ -264,6 +509,23 @@ int main(void)
 
 	LOG_INF("HAL BLE inicializado");
 	
+	// Estado anunciado no advertising: bateria a cada amostragem, alarme
+	// a cada início e fim do buzzer intermitente
+	adv_status_update();
+	hal_battery_register_sample_cb(on_battery_sample);
+	hal_buzzer_set_state_callback(on_buzzer_state);
+	
+	// ========== Inicialização do Dome Virtual ==========
+	
+	err = proximity_init(on_proximity_zone);
+	if (err != PROXIMITY_SUCCESS) 
+	{
+		LOG_ERR("Falha ao inicializar motor de proximidade (err %d)", err);
+		return -1;
+	}
+	
+	LOG_INF("Motor de proximidade inicializado");
+	
 	// ========== Inicialização Serviço GATT Buzzer ==========
 	
 	err = gatt_buzzer_service_init(&buzzer_callbacks);
@@ -286,14 +548,36 @@ int main(void)
 
 	LOG_INF("Serviço GATT Battery inicializado");
 	
+	// ========== Inicialização Serviço GATT Link Loss ==========
+	
+	err = gatt_link_loss_service_init(&link_loss_callbacks);
+	if (err != 0) 
+	{
+		LOG_ERR("Falha ao inicializar serviço GATT Link Loss (err %d)", err);
+		return -1;
+	}
+	
+	LOG_INF("Serviço GATT Link Loss inicializado");
+	
+	// ========== Inicialização Serviço GATT Immediate Alert ==========
+	
+	err = gatt_immediate_alert_service_init(&immediate_alert_callbacks);
+	if (err != 0) 
+	{
+		LOG_ERR("Falha ao inicializar serviço GATT Immediate Alert (err %d)", err);
+		return -1;
+	}
+	
+	LOG_INF("Serviço GATT Immediate Alert inicializado");
+	
 	// ========== Inicia Advertising ==========
 	
 	// Parâmetros customizados de advertising
 	hal_ble_adv_params_t adv_params = {
-		.interval_min_ms = 500,
-		.interval_max_ms = 500,
 		.connectable = true,
 		.use_identity = true,
+		.stages = adv_schedule,
+		.stage_count = ARRAY_SIZE(adv_schedule),
 	};
 	
 	err = hal_ble_start_advertising(&adv_params);
@@ -304,6 +588,26 @@ int main(void)
 		return -1;
 	}
 	
+	// Trem periódico com o estado da coleira (não essencial)
+	if (IS_ENABLED(CONFIG_HAL_BLE_PERIODIC_ADV)) 
+	{
+		err = hal_ble_start_periodic_adv(0);
+		if (err != HAL_BLE_SUCCESS) 
+		{
+			LOG_WRN("Advertising periódico indisponível (err %d)", err);
+		}
+	}
+	
+	// Beacon não conectável para o radar por RSSI (não essencial)
+	if (IS_ENABLED(CONFIG_HAL_BLE_BEACON)) 
+	{
+		err = hal_ble_start_beacon(NULL);
+		if (err != HAL_BLE_SUCCESS) 
+		{
+			LOG_WRN("Beacon indisponível (err %d)", err);
+		}
+	}
+	
 	// ========== Sistema Pronto ==========
 	
 	// Não apaga LED verde após inicialização
@@ -315,6 +619,8 @@ int main(void)
 	LOG_INF("  Controle remoto disponível via BLE:");
 	LOG_INF("    - Buzzer Intermitente (0x00=OFF, 0x01=ON)");
 	LOG_INF("    - Battery Service (0x180F) - Leitura sob demanda");
+	LOG_INF("    - Link Loss Service (0x1803) - Alerta na perda do enlace");
+	LOG_INF("    - Immediate Alert Service (0x1802) - Alerta imediato (0-2)");
 	LOG_INF("==================================================");
 	
 	for (;;) 
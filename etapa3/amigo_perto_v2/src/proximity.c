@@ -0,0 +1,642 @@
+/*
+ * Proximity - Motor de proximidade (dome virtual)
+ * 
+ * @file proximity.c
+ * @brief Estimativa de distância pelo RSSI e alarme local do dome virtual
+ * Localização: src/proximity.c
+ * Header público: include/proximity.h
+ * 
+ * Características:
+ * - Consome as amostras de RSSI do HAL BLE (work queue do sistema)
+ * - Mediana de 5 amostras descarta picos de desvanecimento; a média
+ *   móvel exponencial em Q8 suaviza o restante
+ * - Modelo log-distância d = 10^((P1m - RSSI) / (10 n)) avaliado com
+ *   tabela de 10^(i/20) e interpolação linear, só com inteiros
+ * - Troca de zona exige ultrapassar o raio (ou voltar abaixo do raio menos
+ *   a histerese) e permanecer assim pelo tempo de dwell
+ * - Com LE Power Control, os limiares de perda de percurso equivalentes ao
+ *   raio são entregues ao controlador, que só acorda a aplicação nas
+ *   trocas de zona; o dwell é confirmado por um work item
+ * - Pré-alarme de perda de enlace: RSSI filtrado perto do limite de
+ *   sensibilidade e caindo rápido aciona o alarme sem aguardar o dwell
+ * - O buzzer é acionado aqui mesmo, sem ida e volta ao celular
+ * 
+ * Copyright (c) 2025
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "proximity.h"
+
+// Zephyr includes
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+// Hardware Abstraction Layer
+#include "hal/ble.h"
+#include "hal/buzzer.h"
+
+// Registra módulo de logging
+LOG_MODULE_REGISTER(proximity, LOG_LEVEL_DBG);
+
+/*******************************************************************************
+ * CONFIGURAÇÕES E CONSTANTES
+ ******************************************************************************/
+
+// Janela do filtro de mediana
+#define MEDIAN_WINDOW           5
+
+// Peso da amostra nova na média móvel exponencial (Q8: 256 = 1,0)
+#define EMA_ALPHA_Q8            CONFIG_PROXIMITY_EMA_ALPHA_Q8
+
+// Modelo de perda de percurso: RSSI a 1 m e expoente n (x10)
+#define TX_POWER_1M_DBM         CONFIG_PROXIMITY_TX_POWER_1M_DBM
+#define PATH_LOSS_EXP_X10       CONFIG_PROXIMITY_PATH_LOSS_EXP_X10
+
+// Histerese de distância e tempos de permanência para trocar de zona
+#define HYSTERESIS_CM           CONFIG_PROXIMITY_HYSTERESIS_CM
+#define DWELL_OUT_MS            CONFIG_PROXIMITY_DWELL_OUT_MS
+#define DWELL_IN_MS             CONFIG_PROXIMITY_DWELL_IN_MS
+
+// Potência de transmissão do central: perda de percurso = TX - RSSI
+#define PEER_TX_POWER_DBM       CONFIG_HAL_BLE_PEER_TX_POWER_DBM
+
+// Histerese e permanência mínima aplicadas pelo controlador aos limiares
+#define PATH_LOSS_HYSTERESIS_DB 2
+#define PATH_LOSS_MIN_EVENTS    4
+
+// Janela de medição da tendência do RSSI filtrado (pré-alarme)
+#define TREND_WINDOW_MS         2000
+
+// Intensidade do alarme de saída do dome
+#define ALARM_INTENSITY         HAL_BUZZER_INTENSITY_HIGH
+
+// Tabela de 100 * 10^(i/20) cm, de 10 cm (i = -20) a 1000 m (i = 60):
+// cada passo vale 1/20 de década (~12%)
+#define POW10_STEPS             20
+#define POW10_OFFSET            20
+
+static const uint32_t pow10_cm[] = {
+	10, 11, 13, 14, 16, 18, 20, 22, 25, 28,
+	32, 35, 40, 45, 50, 56, 63, 71, 79, 89,
+	100, 112, 126, 141, 158, 178, 200, 224, 251, 282,
+	316, 355, 398, 447, 501, 562, 631, 708, 794, 891,
+	1000, 1122, 1259, 1413, 1585, 1778, 1995, 2239, 2512, 2818,
+	3162, 3548, 3981, 4467, 5012, 5623, 6310, 7079, 7943, 8913,
+	10000, 11220, 12589, 14125, 15849, 17783, 19953, 22387, 25119, 28184,
+	31623, 35481, 39811, 44668, 50119, 56234, 63096, 70795, 79433, 89125,
+	100000,
+};
+
+#define POW10_LAST              (ARRAY_SIZE(pow10_cm) - 1)
+
+/*******************************************************************************
+ * VARIÁVEIS PRIVADAS
+ ******************************************************************************/
+
+static bool initialized = false;
+static proximity_zone_cb_t user_zone_cb = NULL;
+
+// Raio do dome virtual
+static uint32_t radius_cm = CONFIG_PROXIMITY_RADIUS_CM;
+
+// Filtro de mediana (buffer circular das últimas amostras)
+static int8_t median_window[MEDIAN_WINDOW];
+static uint8_t median_count = 0;
+static uint8_t median_next = 0;
+
+// Média móvel exponencial do RSSI (dBm em Q8)
+static int32_t ema_q8;
+static bool ema_valid = false;
+
+// Início da janela de tendência do RSSI filtrado
+static int32_t trend_start_q8;
+static uint32_t trend_start_ms;
+static bool trend_valid = false;
+
+// Conexão que originou as amostras nos filtros
+static uint8_t sample_conn_id;
+
+// Zona candidata e instante em que passou a ser observada
+static proximity_zone_t candidate_zone = PROXIMITY_ZONE_UNKNOWN;
+static uint32_t candidate_since_ms;
+
+// Estado lido por qualquer contexto
+static atomic_t current_zone = ATOMIC_INIT(PROXIMITY_ZONE_UNKNOWN);
+static atomic_t current_distance_cm = ATOMIC_INIT(-1);
+
+// Descarte dos filtros pedido por proximity_reset(), aplicado na próxima
+// amostra (os filtros só são tocados pela work queue do sistema)
+static atomic_t reset_pending = ATOMIC_INIT(0);
+
+// Última zona e perda de percurso reportadas pelo controlador
+static atomic_t path_loss_zone = ATOMIC_INIT(HAL_BLE_PATH_LOSS_ZONE_MIDDLE);
+static atomic_t path_loss_db = ATOMIC_INIT(0);
+
+// Levam o aviso do controlador para a work queue e confirmam o dwell
+static struct k_work path_loss_work;
+static struct k_work_delayable dwell_work;
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - FILTROS
+ ******************************************************************************/
+
+/**
+ * @brief Insere uma amostra e retorna a mediana da janela
+ * 
+ * Enquanto a janela não enche, usa as amostras disponíveis.
+ */
+static int8_t median_filter(int8_t rssi)
+{
+	int8_t sorted[MEDIAN_WINDOW];
+	
+	median_window[median_next] = rssi;
+	median_next = (median_next + 1) % MEDIAN_WINDOW;
+	
+	if (median_count < MEDIAN_WINDOW) 
+	{
+		median_count++;
+	}
+	
+	// Ordenação por inserção: no máximo 5 elementos
+	for (uint8_t i = 0; i < median_count; i++) 
+	{
+		int8_t value = median_window[i];
+		int8_t j = i - 1;
+		
+		while (j >= 0 && sorted[j] > value) 
+		{
+			sorted[j + 1] = sorted[j];
+			j--;
+		}
+		
+		sorted[j + 1] = value;
+	}
+	
+	return sorted[median_count / 2];
+}
+
+/**
+ * @brief Atualiza a média móvel exponencial
+ * 
+ * @param rssi Amostra (já filtrada pela mediana) em dBm
+ * @return Média em dBm (Q8)
+ */
+static int32_t ema_update(int8_t rssi)
+{
+	int32_t sample_q8 = (int32_t)rssi * 256;
+	
+	if (!ema_valid) 
+	{
+		ema_q8 = sample_q8;
+		ema_valid = true;
+	}
+	else 
+	{
+		ema_q8 += ((sample_q8 - ema_q8) * EMA_ALPHA_Q8) / 256;
+	}
+	
+	return ema_q8;
+}
+
+/**
+ * @brief Converte o RSSI filtrado em distância pelo modelo log-distância
+ * 
+ * O expoente (P1m - RSSI) / (10 n) é calculado em passos da tabela
+ * pow10_cm (Q8) e a distância é interpolada entre os dois passos vizinhos.
+ * Fora da tabela, satura em 10 cm ou 1000 m.
+ * 
+ * @param rssi_q8 RSSI em dBm (Q8)
+ * @return Distância estimada em cm
+ */
+static uint32_t rssi_to_distance_cm(int32_t rssi_q8)
+{
+	// Perda de percurso em relação a 1 m (dB, Q8)
+	int32_t loss_q8 = TX_POWER_1M_DBM * 256 - rssi_q8;
+	
+	// Posição na tabela (Q8): 10 n = PATH_LOSS_EXP_X10 dB por década
+	int32_t pos_q8 = (loss_q8 * POW10_STEPS) / PATH_LOSS_EXP_X10 + POW10_OFFSET * 256;
+	
+	if (pos_q8 <= 0) 
+	{
+		return pow10_cm[0];
+	}
+	
+	uint32_t index = (uint32_t)pos_q8 >> 8;
+	uint32_t frac = (uint32_t)pos_q8 & 0xFF;
+	
+	if (index >= POW10_LAST) 
+	{
+		return pow10_cm[POW10_LAST];
+	}
+	
+	return pow10_cm[index] + (((pow10_cm[index + 1] - pow10_cm[index]) * frac) >> 8);
+}
+
+/**
+ * @brief Converte uma distância na perda de percurso equivalente
+ * 
+ * Inverso de rssi_to_distance_cm() pela mesma tabela: 10 n log10(d) é o
+ * primeiro passo com distância maior ou igual a d.
+ * 
+ * @param distance_cm Distância em cm
+ * @return Perda de percurso em dB
+ */
+static uint8_t distance_to_path_loss_db(uint32_t distance_cm)
+{
+	uint32_t index = 0;
+	
+	while (index < POW10_LAST && pow10_cm[index] < distance_cm) 
+	{
+		index++;
+	}
+	
+	int32_t loss = PEER_TX_POWER_DBM - TX_POWER_1M_DBM +
+	               ((int32_t)index - POW10_OFFSET) * PATH_LOSS_EXP_X10 / POW10_STEPS;
+	
+	return (uint8_t)CLAMP(loss, 1, UINT8_MAX - 1);
+}
+
+/**
+ * @brief Descarta apenas o histórico de RSSI dos filtros
+ */
+static void history_clear(void)
+{
+	median_count = 0;
+	median_next = 0;
+	ema_valid = false;
+	trend_valid = false;
+}
+
+/**
+ * @brief Descarta o histórico dos filtros e a zona candidata
+ */
+static void filters_clear(void)
+{
+	history_clear();
+	candidate_zone = PROXIMITY_ZONE_UNKNOWN;
+}
+
+/**
+ * @brief Aplica o descarte pedido por proximity_reset(), se houver
+ */
+static void reset_apply(void)
+{
+	if (atomic_cas(&reset_pending, 1, 0)) 
+	{
+		filters_clear();
+	}
+}
+
+/*******************************************************************************
+ * FUNÇÕES PRIVADAS - ZONAS
+ ******************************************************************************/
+
+/**
+ * @brief Aplica uma troca de zona: aciona ou desliga o buzzer
+ */
+static void zone_change(proximity_zone_t zone, uint32_t distance_cm)
+{
+	atomic_set(&current_zone, zone);
+	
+	// Pede ou retira apenas o alarme deste módulo: o buzzer segue tocando
+	// enquanto o app, o IAS ou o Link Loss ainda o quiserem
+	bool outside = (zone == PROXIMITY_ZONE_OUTSIDE);
+	
+	int err = hal_buzzer_set_alarm(HAL_BUZZER_SOURCE_PROXIMITY, outside, ALARM_INTENSITY);
+	if (err != HAL_BUZZER_SUCCESS) 
+	{
+		LOG_ERR("Falha ao controlar alarme de proximidade (err %d)", err);
+	}
+	
+	LOG_INF("Zona: %s (%u cm, raio %u cm)",
+	        zone == PROXIMITY_ZONE_OUTSIDE ? "FORA" : "DENTRO", distance_cm, radius_cm);
+	
+	if (user_zone_cb) 
+	{
+		user_zone_cb(zone, distance_cm);
+	}
+}
+
+/**
+ * @brief Avalia a distância contra o raio, com histerese e dwell
+ * 
+ * Entre o raio menos a histerese e o raio, a zona atual é mantida. Uma
+ * nova zona só é aplicada depois de observada continuamente pelo tempo de
+ * permanência correspondente.
+ * 
+ * @param distance_cm Distância estimada
+ * @param timestamp_ms Instante da amostra
+ */
+static void zone_evaluate(uint32_t distance_cm, uint32_t timestamp_ms)
+{
+	proximity_zone_t zone = (proximity_zone_t)atomic_get(&current_zone);
+	proximity_zone_t target = zone;
+	
+	if (distance_cm > radius_cm) 
+	{
+		target = PROXIMITY_ZONE_OUTSIDE;
+	}
+	else if (distance_cm + HYSTERESIS_CM < radius_cm || zone == PROXIMITY_ZONE_UNKNOWN) 
+	{
+		target = PROXIMITY_ZONE_INSIDE;
+	}
+	
+	if (target == zone) 
+	{
+		candidate_zone = zone;
+		return;
+	}
+	
+	if (target != candidate_zone) 
+	{
+		candidate_zone = target;
+		candidate_since_ms = timestamp_ms;
+	}
+	
+	uint32_t dwell_ms = (target == PROXIMITY_ZONE_OUTSIDE) ? DWELL_OUT_MS : DWELL_IN_MS;
+	
+	if (timestamp_ms - candidate_since_ms < dwell_ms) 
+	{
+		return;
+	}
+	
+	zone_change(target, distance_cm);
+}
+
+/**
+ * @brief Zona indicada pela última zona de perda de percurso reportada
+ * 
+ * A zona intermediária (entre os limiares) mantém a zona atual.
+ */
+static proximity_zone_t path_loss_target(void)
+{
+	proximity_zone_t zone = (proximity_zone_t)atomic_get(&current_zone);
+	
+	switch (atomic_get(&path_loss_zone)) {
+	case HAL_BLE_PATH_LOSS_ZONE_NEAR:
+		return PROXIMITY_ZONE_INSIDE;
+	
+	case HAL_BLE_PATH_LOSS_ZONE_FAR:
+		return PROXIMITY_ZONE_OUTSIDE;
+	
+	default:
+		return (zone == PROXIMITY_ZONE_UNKNOWN) ? PROXIMITY_ZONE_INSIDE : zone;
+	}
+}
+
+/**
+ * @brief Handler do aviso de troca de zona do controlador
+ * 
+ * Inicia a contagem do dwell rumo à nova zona, ou a cancela se a perda
+ * de percurso voltou para a zona atual.
+ */
+static void path_loss_work_handler(struct k_work *work)
+{
+	reset_apply();
+	
+	int32_t rssi_q8 = (PEER_TX_POWER_DBM - (int32_t)atomic_get(&path_loss_db)) * 256;
+	
+	atomic_set(&current_distance_cm, (atomic_val_t)rssi_to_distance_cm(rssi_q8));
+	
+	proximity_zone_t target = path_loss_target();
+	
+	if (target == (proximity_zone_t)atomic_get(&current_zone)) 
+	{
+		k_work_cancel_delayable(&dwell_work);
+		return;
+	}
+	
+	uint32_t dwell_ms = (target == PROXIMITY_ZONE_OUTSIDE) ? DWELL_OUT_MS : DWELL_IN_MS;
+	
+	// Não reinicia uma contagem já em andamento
+	k_work_schedule(&dwell_work, K_MSEC(dwell_ms));
+}
+
+/**
+ * @brief Handler do fim do dwell no monitoramento de perda de percurso
+ */
+static void dwell_work_handler(struct k_work *work)
+{
+	proximity_zone_t target = path_loss_target();
+	
+	if (target != (proximity_zone_t)atomic_get(&current_zone)) 
+	{
+		zone_change(target, (uint32_t)atomic_get(&current_distance_cm));
+	}
+}
+
+/**
+ * @brief Callback de troca de zona do controlador (thread RX do Bluetooth)
+ */
+static void on_path_loss_zone(hal_ble_path_loss_zone_t zone, uint8_t path_loss)
+{
+	atomic_set(&path_loss_zone, zone);
+	atomic_set(&path_loss_db, path_loss);
+	k_work_submit(&path_loss_work);
+}
+
+/**
+ * @brief Entrega ao controlador os limiares equivalentes ao raio
+ * 
+ * Sem suporte no controlador, o HAL BLE mantém a amostragem de RSSI e as
+ * amostras seguem por on_rssi_sample().
+ */
+static void path_loss_configure(void)
+{
+	uint8_t far_db = distance_to_path_loss_db(radius_cm);
+	uint8_t near_db = distance_to_path_loss_db(radius_cm - HYSTERESIS_CM);
+	
+	const hal_ble_path_loss_params_t params = {
+		.near_db = MIN(near_db, far_db - 1),
+		.far_db = far_db,
+		.hysteresis_db = PATH_LOSS_HYSTERESIS_DB,
+		.min_events = PATH_LOSS_MIN_EVENTS,
+	};
+	
+	int err = hal_ble_set_path_loss_monitor(&params, on_path_loss_zone);
+	if (err != HAL_BLE_SUCCESS) 
+	{
+		LOG_WRN("Falha ao configurar limiares de perda de percurso (err %d)", err);
+	}
+}
+
+#if defined(CONFIG_PROXIMITY_PREWARN)
+
+/**
+ * @brief Avalia o pré-alarme de perda de enlace pela tendência do RSSI
+ * 
+ * A inclinação do RSSI filtrado é medida a cada TREND_WINDOW_MS. O
+ * pré-alarme dispara quando o sinal já está perto do limite de
+ * sensibilidade e ainda caindo rápido: o enlace deve cair antes que o
+ * dwell (ou o timeout de supervisão) se complete.
+ * 
+ * @param rssi_q8 RSSI filtrado em dBm (Q8)
+ * @param timestamp_ms Instante da amostra
+ * @return true se o pré-alarme deve ser disparado
+ */
+static bool prewarn_check(int32_t rssi_q8, uint32_t timestamp_ms)
+{
+	if (!trend_valid) 
+	{
+		trend_start_q8 = rssi_q8;
+		trend_start_ms = timestamp_ms;
+		trend_valid = true;
+		return false;
+	}
+	
+	uint32_t elapsed_ms = timestamp_ms - trend_start_ms;
+	
+	if (elapsed_ms < TREND_WINDOW_MS) 
+	{
+		return false;
+	}
+	
+	// Inclinação em dB/s (Q8)
+	int32_t slope_q8 = ((rssi_q8 - trend_start_q8) * 1000) / (int32_t)elapsed_ms;
+	
+	trend_start_q8 = rssi_q8;
+	trend_start_ms = timestamp_ms;
+	
+	return rssi_q8 < CONFIG_PROXIMITY_PREWARN_RSSI_DBM * 256 &&
+	       slope_q8 <= -CONFIG_PROXIMITY_PREWARN_SLOPE_DB_S * 256;
+}
+
+#endif /* CONFIG_PROXIMITY_PREWARN */
+
+/**
+ * @brief Callback das amostras de RSSI do HAL BLE
+ */
+static void on_rssi_sample(const hal_ble_rssi_sample_t *sample)
+{
+	reset_apply();
+	
+	// Outro celular assumiu a conexão principal: o RSSI dele não se mistura
+	// ao do anterior, mas a zona e o alarme seguem até a nova estimativa
+	if (ema_valid && sample->conn_id != sample_conn_id) 
+	{
+		LOG_INF("Dome acompanhando a conexão %u", sample->conn_id);
+		history_clear();
+	}
+	
+	sample_conn_id = sample->conn_id;
+	
+	int8_t median = median_filter(sample->rssi_dbm);
+	int32_t rssi_q8 = ema_update(median);
+	uint32_t distance_cm = rssi_to_distance_cm(rssi_q8);
+	
+	atomic_set(&current_distance_cm, (atomic_val_t)distance_cm);
+	
+	LOG_DBG("RSSI %d dBm, mediana %d, EMA %d.%02d dBm -> %u cm", sample->rssi_dbm,
+	        median, rssi_q8 / 256, (ABS(rssi_q8) % 256) * 100 / 256, distance_cm);
+	
+#if defined(CONFIG_PROXIMITY_PREWARN)
+	if (prewarn_check(rssi_q8, sample->timestamp_ms) &&
+	    atomic_get(&current_zone) != PROXIMITY_ZONE_OUTSIDE) 
+	{
+		LOG_WRN("Pré-alarme: RSSI %d dBm caindo, enlace prestes a cair", rssi_q8 / 256);
+		candidate_zone = PROXIMITY_ZONE_OUTSIDE;
+		zone_change(PROXIMITY_ZONE_OUTSIDE, distance_cm);
+		return;
+	}
+#endif
+	
+	zone_evaluate(distance_cm, sample->timestamp_ms);
+}
+
+/*******************************************************************************
+ * API PÚBLICA
+ ******************************************************************************/
+
+int proximity_init(proximity_zone_cb_t zone_cb)
+{
+	if (initialized) 
+	{
+		LOG_WRN("Motor de proximidade já inicializado");
+		return PROXIMITY_SUCCESS;
+	}
+	
+	user_zone_cb = zone_cb;
+	
+	int err = hal_ble_register_rssi_cb(on_rssi_sample);
+	if (err != HAL_BLE_SUCCESS) 
+	{
+		LOG_ERR("Falha ao assinar amostras de RSSI (err %d)", err);
+		return PROXIMITY_ERROR_STATE;
+	}
+	
+	k_work_init(&path_loss_work, path_loss_work_handler);
+	k_work_init_delayable(&dwell_work, dwell_work_handler);
+	
+	path_loss_configure();
+	
+	initialized = true;
+	
+	LOG_INF("Motor de proximidade inicializado - Raio: %u cm, P1m: %d dBm, n: %d.%d",
+	        radius_cm, TX_POWER_1M_DBM, PATH_LOSS_EXP_X10 / 10, PATH_LOSS_EXP_X10 % 10);
+	
+	return PROXIMITY_SUCCESS;
+}
+
+int proximity_set_radius(uint32_t radius)
+{
+	if (radius <= HYSTERESIS_CM) 
+	{
+		LOG_ERR("Raio inválido: %u cm (histerese de %d cm)", radius, HYSTERESIS_CM);
+		return PROXIMITY_ERROR_INVALID;
+	}
+	
+	radius_cm = radius;
+	
+	if (initialized) 
+	{
+		path_loss_configure();
+	}
+	
+	LOG_INF("Raio do dome: %u cm", radius_cm);
+	return PROXIMITY_SUCCESS;
+}
+
+uint32_t proximity_get_radius(void)
+{
+	return radius_cm;
+}
+
+void proximity_reset(void)
+{
+	atomic_set(&reset_pending, 1);
+	atomic_set(&path_loss_zone, HAL_BLE_PATH_LOSS_ZONE_MIDDLE);
+	atomic_set(&current_zone, PROXIMITY_ZONE_UNKNOWN);
+	atomic_set(&current_distance_cm, -1);
+	
+	if (initialized) 
+	{
+		k_work_cancel_delayable(&dwell_work);
+		
+		// Sem conexão não há dome: o alarme fica com o Link Loss
+		hal_buzzer_set_alarm(HAL_BUZZER_SOURCE_PROXIMITY, false, HAL_BUZZER_INTENSITY_OFF);
+	}
+}
+
+proximity_zone_t proximity_get_zone(void)
+{
+	return (proximity_zone_t)atomic_get(&current_zone);
+}
+
+int proximity_get_distance(uint32_t *distance_cm)
+{
+	if (!distance_cm) 
+	{
+		return PROXIMITY_ERROR_INVALID;
+	}
+	
+	atomic_val_t distance = atomic_get(&current_distance_cm);
+	
+	if (distance < 0) 
+	{
+		return PROXIMITY_ERROR_STATE;
+	}
+	
+	*distance_cm = (uint32_t)distance;
+	
+	return PROXIMITY_SUCCESS;
+}